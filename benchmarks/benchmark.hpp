@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "scriptpp/scriptpp.hpp"
+
+namespace spp::benchmark
+{
+    // Best wall time of a few runs, so a cold cache or a scheduler hiccup doesn't decide the result. setup runs before
+    // every run and is not timed
+    inline double measure(const std::string& name,const std::function<void()>& operation,int runs = 3,const std::function<void()>& setup = {})
+    {
+        double best = -1;
+        for (int i = 0; i < runs; i++)
+        {
+            if (setup)
+            {
+                setup();
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            operation();
+            const std::chrono::duration<double,std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (best < 0 || elapsed.count() < best)
+            {
+                best = elapsed.count();
+            }
+        }
+
+        std::cout << "[benchmark] " << name << " -> " << best << " ms" << '\n';
+        return best;
+    }
+
+    // A module to run script snippets in, print is not available so results are checked from C++
+    class ScriptRunner
+    {
+        std::shared_ptr<runtime::Program> _program = runtime::makeProgram();
+        std::shared_ptr<runtime::Module> _module = runtime::makeModule(_program);
+    public:
+        void Set(const std::string& id,const std::shared_ptr<runtime::Object>& value)
+        {
+            _module->Assign(id,value);
+        }
+
+        std::shared_ptr<runtime::Object> Get(const std::string& id) const
+        {
+            return runtime::resolveReference(_module->Find(id));
+        }
+
+        std::shared_ptr<runtime::Object> Run(const std::string& source)
+        {
+            auto tokens = frontend::tokenize(source,"<benchmark>");
+            const auto ast = frontend::parse(tokens);
+            std::shared_ptr<runtime::Object> result{};
+            for (auto& statement : ast->statements)
+            {
+                result = runtime::evalStatement(statement,_module);
+            }
+
+            return result;
+        }
+    };
+}
@@ -0,0 +1,151 @@
+// ObjectMap, the table behind Dictionary, against the std::unordered_map keyed through Object::GetHashCode/Equal that
+// it replaced. Keys are inserted then looked up in shuffled order.
+// Usage: bench_dictionary [count], count defaults to 1M
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
+#include "benchmark.hpp"
+#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/ObjectMap.hpp"
+
+using namespace spp;
+
+namespace
+{
+    using Keys = std::vector<std::shared_ptr<runtime::Object>>;
+
+    // Lookups use separately made keys so neither table can get away with a pointer compare
+    bool compare(const std::string& name,const Keys& keys,Keys lookups,std::mt19937_64& random)
+    {
+        std::ranges::shuffle(lookups,random);
+        const auto value = runtime::makeNumber(static_cast<int64_t>(1));
+
+        std::unordered_map<std::shared_ptr<runtime::Object>,std::shared_ptr<runtime::Object>> oldMap;
+        benchmark::measure(name + " unordered_map insert",[&]
+        {
+            for (auto& key : keys)
+            {
+                oldMap[key] = value;
+            }
+        },1,[&]{ oldMap.clear(); });
+
+        size_t oldFound = 0;
+        benchmark::measure(name + " unordered_map lookup",[&]
+        {
+            oldFound = 0;
+            for (auto& key : lookups)
+            {
+                oldFound += oldMap.contains(key);
+            }
+        },1);
+
+        runtime::ObjectMap map;
+        benchmark::measure(name + " ObjectMap insert",[&]
+        {
+            for (auto& key : keys)
+            {
+                map.Set(key,value);
+            }
+        },1,[&]{ map.Clear(); });
+
+        size_t found = 0;
+        benchmark::measure(name + " ObjectMap lookup",[&]
+        {
+            found = 0;
+            for (auto& key : lookups)
+            {
+                found += map.Contains(key);
+            }
+        },1);
+
+        if (found != keys.size() || oldFound != keys.size())
+        {
+            std::cerr << name << " lookups found " << found << " and " << oldFound << " of " << keys.size() << " keys" << '\n';
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(const int argc, char *argv[])
+{
+    const size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+
+    std::mt19937_64 random(42);
+    std::vector<int64_t> numbers(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        numbers[i] = static_cast<int64_t>(i);
+    }
+
+    Keys ascending;
+    Keys ascendingLookups;
+    for (const auto number : numbers)
+    {
+        ascending.push_back(runtime::makeNumber(number));
+        ascendingLookups.push_back(runtime::makeNumber(number));
+    }
+
+    std::ranges::shuffle(numbers,random);
+
+    Keys strings;
+    Keys stringLookups;
+    Keys integers;
+    Keys integerLookups;
+    for (const auto number : numbers)
+    {
+        strings.push_back(runtime::makeString("key" + std::to_string(number)));
+        stringLookups.push_back(runtime::makeString("key" + std::to_string(number)));
+        integers.push_back(runtime::makeNumber(number));
+        integerLookups.push_back(runtime::makeNumber(number));
+    }
+
+    std::cout << "Inserting and looking up " << count << " keys" << '\n';
+
+    if (!compare("string keys",strings,stringLookups,random) ||
+        !compare("int keys",integers,integerLookups,random))
+    {
+        return 1;
+    }
+
+    // Keys inserted and looked up in ascending order, the case an identity hash handles best
+    std::unordered_map<std::shared_ptr<runtime::Object>,std::shared_ptr<runtime::Object>> oldMap;
+    runtime::ObjectMap map;
+    const auto value = runtime::makeNumber(static_cast<int64_t>(1));
+    benchmark::measure("ascending int keys unordered_map insert",[&]
+    {
+        for (auto& key : ascending)
+        {
+            oldMap[key] = value;
+        }
+    },1);
+
+    benchmark::measure("ascending int keys unordered_map lookup",[&]
+    {
+        for (auto& key : ascendingLookups)
+        {
+            oldMap.contains(key);
+        }
+    },1);
+
+    benchmark::measure("ascending int keys ObjectMap insert",[&]
+    {
+        for (auto& key : ascending)
+        {
+            map.Set(key,value);
+        }
+    },1);
+
+    benchmark::measure("ascending int keys ObjectMap lookup",[&]
+    {
+        for (auto& key : ascendingLookups)
+        {
+            map.Contains(key);
+        }
+    },1);
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+// List.sort, sortBy and comparator sorts on shuffled lists, against std::ranges::sort on the same numbers.
+// Usage: bench_sort [count], count defaults to 1M
+
+#include <algorithm>
+#include <random>
+
+#include "benchmark.hpp"
+#include "scriptpp/runtime/Number.hpp"
+
+using namespace spp;
+
+int main(const int argc, char *argv[])
+{
+    const size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+
+    std::mt19937_64 random(42);
+    std::vector<int64_t> numbers(count);
+    for (auto& number : numbers)
+    {
+        number = static_cast<int64_t>(random() % (count * 4));
+    }
+
+    std::vector<std::shared_ptr<runtime::Object>> strings;
+    strings.reserve(count);
+    for (const auto number : numbers)
+    {
+        strings.push_back(runtime::makeString("item" + std::to_string(number)));
+    }
+
+    benchmark::ScriptRunner runner;
+
+    // Every run sorts a fresh copy of the shuffled input
+    const auto setNumbers = [&]
+    {
+        runner.Set("l",runtime::makeList(std::vector(numbers)));
+    };
+
+    const auto setStrings = [&]
+    {
+        runner.Set("l",runtime::makeList(strings));
+    };
+
+    std::cout << "Sorting " << count << " items" << '\n';
+
+    std::vector<int64_t> reference;
+    benchmark::measure("std::ranges::sort int64",[&]
+    {
+        std::ranges::sort(reference);
+    },3,[&]
+    {
+        reference = numbers;
+    });
+
+    benchmark::measure("numbers l.sort()",[&]{ runner.Run("l.sort();"); },3,setNumbers);
+    benchmark::measure("numbers l.sort(stable: true)",[&]{ runner.Run("l.sort(stable: true);"); },3,setNumbers);
+    benchmark::measure("strings l.sort()",[&]{ runner.Run("l.sort();"); },3,setStrings);
+    benchmark::measure("numbers l.sortBy(fn(x) -> -x)",[&]{ runner.Run("l.sortBy(fn(x) -> -x);"); },1,setNumbers);
+    benchmark::measure("numbers l.sort(fn(a,b) -> a - b)",[&]{ runner.Run("l.sort(fn(a,b) -> a - b);"); },1,setNumbers);
+
+    // The result has to match the reference, a broken comparator protocol shows up here
+    runner.Set("l",runtime::makeList(std::vector(numbers)));
+    runner.Run("l.sort(fn(a,b) -> a - b);");
+    const auto sorted = cast<runtime::List>(runner.Get("l"));
+    for (size_t i = 0; i < count; i++)
+    {
+        if (castStatic<runtime::Number>(sorted->GetItem(i))->GetValueAs<int64_t>() != reference[i])
+        {
+            std::cerr << "Comparator sort differs from the reference at " << i << '\n';
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// spp::split and spp::trim against the versions they replaced, and strings::find against std::string_view::find.
+// Usage: bench_strings [fields], fields defaults to 100k
+
+#include <vector>
+
+#include "benchmark.hpp"
+
+using namespace spp;
+
+namespace
+{
+    // spp::split before it moved onto strings::split, kept here as the baseline
+    void oldSplit(std::vector<std::string>& result,const std::string& str,const std::string& delimiter = " ")
+    {
+        std::string remaining = str.substr();
+        if(delimiter.empty())
+        {
+            for(auto &r : remaining)
+            {
+                result.emplace_back(1,r);
+            }
+            remaining = "";
+        }
+        else
+        {
+            auto pos = remaining.find_first_of(delimiter);
+            while(pos != std::string::npos)
+            {
+                result.push_back(remaining.substr(0,pos));
+                remaining = remaining.substr(pos + delimiter.size());
+                pos = remaining.find_first_of(delimiter);
+            }
+        }
+
+        if(!remaining.empty())
+        {
+            result.push_back(remaining);
+        }
+    }
+
+    // spp::trim before it moved onto strings::trim
+    std::string oldTrim(const std::string& str)
+    {
+        auto copied = str;
+        const auto toTrim = {' ','\n','\t','\r'};
+        size_t diff = 0;
+        do
+        {
+            const auto start = copied.size();
+            for(auto &c : toTrim)
+            {
+                copied.erase(copied.find_last_not_of(c)+1);
+            }
+
+            diff = copied.size() - start;
+        } while(diff != 0);
+
+        diff = 0;
+        do
+        {
+            const auto start = copied.size();
+            for(auto &c : toTrim)
+            {
+                copied.erase(0, copied.find_first_not_of(c));
+            }
+
+            diff = copied.size() - start;
+        } while(diff != 0);
+
+        return copied;
+    }
+}
+
+int main(const int argc, char *argv[])
+{
+    const size_t fields = argc > 1 ? std::stoull(argv[1]) : 100000;
+
+    // "field0, field1, ..." so both splits see the same number of fields
+    std::string records;
+    for (size_t i = 0; i < fields; i++)
+    {
+        records += "field" + std::to_string(i) + ", ";
+    }
+
+    std::cout << "Splitting " << fields << " fields (" << records.size() << " bytes)" << '\n';
+
+    size_t oldCount = 0;
+    benchmark::measure("old spp::split",[&]
+    {
+        std::vector<std::string> result;
+        oldSplit(result,records,", ");
+        oldCount = result.size();
+    },1);
+
+    size_t newCount = 0;
+    benchmark::measure("spp::split",[&]
+    {
+        std::vector<std::string> result;
+        split(result,records,", ");
+        newCount = result.size();
+    });
+
+    benchmark::measure("strings::split",[&]
+    {
+        std::vector<std::string_view> result;
+        strings::split(result,records,", ");
+    });
+
+    // The new split keeps the empty field after the trailing delimiter
+    if (oldCount + 1 != newCount)
+    {
+        std::cerr << "Split produced " << newCount << " fields, expected " << oldCount + 1 << '\n';
+        return 1;
+    }
+
+    const auto padded = std::string(fields,' ') + records + std::string(fields,'\n');
+    benchmark::measure("old spp::trim",[&]{ oldTrim(padded); });
+    benchmark::measure("spp::trim",[&]{ trim(padded); });
+
+    // The needle shares its first bytes with every field and only matches at the end, so the whole haystack is scanned
+    // and every field is a candidate for a byte-at-a-time search
+    const auto haystack = records + "fieldend";
+    // Each measurement is 100 searches, a single one is too short to time
+    size_t stdFound = 0;
+    size_t found = 0;
+    benchmark::measure("100x std::string_view::find",[&]
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            stdFound += std::string_view(haystack).find("fieldend",i);
+        }
+    });
+
+    benchmark::measure("100x strings::find",[&]
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            found += strings::find(haystack,"fieldend",i);
+        }
+    });
+
+    if (found != stdFound)
+    {
+        std::cerr << "strings::find disagrees with std::string_view::find" << '\n';
+        return 1;
+    }
+
+    benchmark::ScriptRunner runner;
+    runner.Set("s",runtime::makeString(records));
+    benchmark::measure("script s.split(\", \")",[&]{ runner.Run("s.split(\", \");"); });
+
+    return 0;
+}
@@ -0,0 +1,429 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "runtime/DynamicObject.hpp"
+#include "runtime/NativeCall.hpp"
+#include "runtime/Prototype.hpp"
+
+// Exposes plain C++ classes to scripts, e.g.
+//
+//     static const auto cls = bind::Class<Vec>("Vec")
+//         .Constructor<double,double>({"x","y"})
+//         .Method<&Vec::Length>("length")
+//         .Method<&Vec::Add>("__add__");
+//     program->Set("Vec",cls.GetPrototype());
+//
+// Argument conversion and dispatch are generated at compile time, the method table is built once and shared by every
+// instance, and the C++ object lives inline in the script object.
+namespace spp::bind
+{
+    template<typename T>
+    class Instance;
+
+    template<typename T>
+    class ClassPrototype;
+
+    // Everything the prototype and the instances of a bound class share
+    template<typename T>
+    struct ClassInfo
+    {
+        std::string name;
+        runtime::NativeMethodTable<Instance<T>> methods{};
+        std::vector<std::string> constructorParams{};
+        runtime::NativeFunctionPointer constructor = nullptr;
+    };
+
+    // Script object holding a T
+    template<typename T>
+    class Instance : public runtime::DynamicObject
+    {
+        std::shared_ptr<const ClassInfo<T>> _info;
+        T _value;
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<runtime::Function> BindNativeMethod(const std::string& id) const override;
+    public:
+        template<typename ...TArgs>
+        explicit Instance(const std::shared_ptr<const ClassInfo<T>>& info,TArgs&&... args);
+
+        std::string ToString(const std::shared_ptr<runtime::ScopeLike>& scope) const override;
+
+        size_t GetHashCode(const std::shared_ptr<runtime::ScopeLike>& scope) override;
+
+        T& Get();
+        const T& Get() const;
+
+        const std::shared_ptr<const ClassInfo<T>>& GetInfo() const;
+    };
+
+    // Calling the prototype from a script runs the constructor registered with Class::Constructor
+    template<typename T>
+    class ClassPrototype : public runtime::Prototype
+    {
+        std::shared_ptr<const ClassInfo<T>> _info;
+        std::shared_ptr<runtime::FastNativeFunction> _construct{};
+    public:
+        explicit ClassPrototype(const std::shared_ptr<const ClassInfo<T>>& info);
+
+        void Init() override;
+
+        std::string ToString(const std::shared_ptr<runtime::ScopeLike>& scope) const override;
+
+        std::shared_ptr<runtime::DynamicObject> CreateInstance(std::shared_ptr<runtime::FunctionScope>& scope) override;
+
+        std::string GetName() const override;
+
+        const std::shared_ptr<const ClassInfo<T>>& GetInfo() const;
+    };
+
+    namespace detail
+    {
+        using runtime::detail::NativeBare;
+
+        // A bound class taken by reference, e.g. const Vec& other
+        template<typename TArg>
+        constexpr bool isBoundReference = std::is_reference_v<TArg> && std::is_class_v<NativeBare<TArg>>
+            && !runtime::detail::isNativeContext<TArg> && !runtime::detail::isNativeRest<TArg>
+            && !runtime::detail::IsSharedPtr<NativeBare<TArg>>::value && !std::is_same_v<NativeBare<TArg>,std::string>;
+
+        template<typename TArg>
+        decltype(auto) argument(runtime::NativeArgs args,size_t index,runtime::NativeCallContext& ctx)
+        {
+            if constexpr (isBoundReference<TArg>)
+            {
+                const auto instance = index < args.size() ? dynamic_cast<Instance<NativeBare<TArg>>*>(args[index].get()) : nullptr;
+                if(!instance)
+                {
+                    runtime::throwNativeArgumentError(ctx,index);
+                }
+
+                return (instance->Get());
+            }
+            else
+            {
+                return runtime::detail::nativeArgument<TArg>(args,index,ctx);
+            }
+        }
+
+        // A T returned by value becomes a new instance, a reference to the receiver returns the receiver itself
+        template<typename T,typename R>
+        std::shared_ptr<runtime::Object> result(Instance<T>& self,R&& value)
+        {
+            if constexpr (std::is_same_v<NativeBare<R>,T>)
+            {
+                if constexpr (std::is_lvalue_reference_v<R>)
+                {
+                    if(&value == &self.Get())
+                    {
+                        return self.GetRef();
+                    }
+                }
+
+                return runtime::makeObject<Instance<T>>(self.GetInfo(),std::forward<R>(value));
+            }
+            else
+            {
+                return runtime::detail::nativeReturn(std::forward<R>(value));
+            }
+        }
+
+        template<typename T>
+        Instance<T>& self(const std::shared_ptr<runtime::Object>& owner)
+        {
+            // Methods are only ever bound to instances of their own class
+            if(!owner)
+            {
+                throw std::runtime_error("Native method called without an instance");
+            }
+
+            return *static_cast<Instance<T>*>(owner.get());
+        }
+
+        template<typename T,typename R,typename ...TArgs>
+        struct MethodInvoker
+        {
+            template<auto Fn,size_t ...I>
+            static std::shared_ptr<runtime::Object> Invoke(runtime::NativeArgs args,runtime::NativeCallContext& ctx,std::index_sequence<I...>)
+            {
+                constexpr auto slots = runtime::detail::nativeArgumentSlots<TArgs...>();
+                const auto owner = ctx.GetSelf();
+                auto& instance = self<T>(owner);
+                if constexpr (std::is_member_function_pointer_v<decltype(Fn)>)
+                {
+                    if constexpr (std::is_void_v<R>)
+                    {
+                        (instance.Get().*Fn)(argument<TArgs>(args,slots[I],ctx)...);
+                        return {};
+                    }
+                    else
+                    {
+                        return result<T,R>(instance,(instance.Get().*Fn)(argument<TArgs>(args,slots[I],ctx)...));
+                    }
+                }
+                else
+                {
+                    if constexpr (std::is_void_v<R>)
+                    {
+                        Fn(instance.Get(),argument<TArgs>(args,slots[I],ctx)...);
+                        return {};
+                    }
+                    else
+                    {
+                        return result<T,R>(instance,Fn(instance.Get(),argument<TArgs>(args,slots[I],ctx)...));
+                    }
+                }
+            }
+        };
+
+        // Members of T or one of its bases, or free functions taking the T first
+        template<typename T,typename TFn>
+        struct Method;
+
+        template<typename T,typename R,typename C,typename ...TArgs>
+        struct Method<T,R(C::*)(TArgs...)> : MethodInvoker<T,R,TArgs...> {};
+
+        template<typename T,typename R,typename C,typename ...TArgs>
+        struct Method<T,R(C::*)(TArgs...) const> : MethodInvoker<T,R,TArgs...> {};
+
+        template<typename T,typename R,typename C,typename ...TArgs>
+        struct Method<T,R(C::*)(TArgs...) noexcept> : MethodInvoker<T,R,TArgs...> {};
+
+        template<typename T,typename R,typename C,typename ...TArgs>
+        struct Method<T,R(C::*)(TArgs...) const noexcept> : MethodInvoker<T,R,TArgs...> {};
+
+        template<typename T,typename R,typename TSelf,typename ...TArgs>
+        struct Method<T,R(*)(TSelf&,TArgs...)> : MethodInvoker<T,R,TArgs...> {};
+
+        template<typename TFn>
+        struct MethodArity;
+
+        template<typename R,typename C,typename ...TArgs>
+        struct MethodArity<R(C::*)(TArgs...)> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<typename R,typename C,typename ...TArgs>
+        struct MethodArity<R(C::*)(TArgs...) const> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<typename R,typename C,typename ...TArgs>
+        struct MethodArity<R(C::*)(TArgs...) noexcept> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<typename R,typename C,typename ...TArgs>
+        struct MethodArity<R(C::*)(TArgs...) const noexcept> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<typename R,typename TSelf,typename ...TArgs>
+        struct MethodArity<R(*)(TSelf&,TArgs...)> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<typename T,auto Fn>
+        std::shared_ptr<runtime::Object> methodThunk(runtime::NativeArgs args,runtime::NativeCallContext& ctx)
+        {
+            return Method<T,decltype(Fn)>::template Invoke<Fn>(args,ctx,std::make_index_sequence<MethodArity<decltype(Fn)>::value>{});
+        }
+
+        template<typename T,typename ...TArgs>
+        std::shared_ptr<runtime::Object> constructThunk(runtime::NativeArgs args,runtime::NativeCallContext& ctx)
+        {
+            constexpr auto slots = runtime::detail::nativeArgumentSlots<TArgs...>();
+            const auto owner = ctx.GetSelf();
+            const auto& info = static_cast<ClassPrototype<T>*>(owner.get())->GetInfo();
+            return [&]<size_t ...I>(std::index_sequence<I...>) -> std::shared_ptr<runtime::Object>
+            {
+                return runtime::makeObject<Instance<T>>(info,argument<TArgs>(args,slots[I],ctx)...);
+            }(std::index_sequence_for<TArgs...>{});
+        }
+
+        template<typename T>
+        std::shared_ptr<runtime::Object> notConstructible(runtime::NativeArgs args,runtime::NativeCallContext& ctx)
+        {
+            const auto owner = ctx.GetSelf();
+            throw std::runtime_error(static_cast<ClassPrototype<T>*>(owner.get())->GetName() + " cannot be constructed from scripts");
+        }
+    }
+
+    // Builds the binding of T. Copies share the same class, finish adding methods before the first instance is made
+    template<typename T>
+    class Class
+    {
+        std::shared_ptr<ClassInfo<T>> _info;
+        mutable std::shared_ptr<ClassPrototype<T>> _prototype{};
+    public:
+        explicit Class(const std::string& name);
+
+        // Parameters are converted the way bindNative converts them, a const T& or T& of another bound class is
+        // passed the object held by that instance
+        template<auto Fn>
+        Class& Method(const std::string& name,const std::vector<std::string>& params = {});
+
+        // Scripts construct T from these parameter types, T is default constructed when this is not called
+        template<typename ...TArgs>
+        Class& Constructor(const std::vector<std::string>& params = {});
+
+        std::shared_ptr<ClassPrototype<T>> GetPrototype() const;
+
+        template<typename ...TArgs>
+        std::shared_ptr<Instance<T>> New(TArgs&&... args) const;
+
+        std::string GetName() const;
+    };
+
+    // The T held by obj, or null when obj is not an instance of a class bound for T
+    template<typename T>
+    T* getNative(const std::shared_ptr<runtime::Object>& obj);
+
+    template <typename T>
+    bool Instance<T>::HasNativeMethod(const std::string& id) const
+    {
+        return _info->methods.Has(id);
+    }
+
+    template <typename T>
+    std::shared_ptr<runtime::Function> Instance<T>::BindNativeMethod(const std::string& id) const
+    {
+        return _info->methods.Bind(id,this);
+    }
+
+    template <typename T>
+    template <typename ... TArgs>
+    Instance<T>::Instance(const std::shared_ptr<const ClassInfo<T>>& info, TArgs&&... args) : DynamicObject({}), _info(info), _value(std::forward<TArgs>(args)...)
+    {
+    }
+
+    template <typename T>
+    std::string Instance<T>::ToString(const std::shared_ptr<runtime::ScopeLike>& scope) const
+    {
+        if(_info->methods.Has(runtime::ReservedDynamicFunctions::TO_STRING))
+        {
+            return DynamicObject::ToString(scope);
+        }
+
+        return "<" + _info->name + " " + std::to_string(GetAddress()) + ">";
+    }
+
+    template <typename T>
+    size_t Instance<T>::GetHashCode(const std::shared_ptr<runtime::ScopeLike>& scope)
+    {
+        return hashCombine(DynamicObject::GetHashCode(scope),GetAddress());
+    }
+
+    template <typename T>
+    T& Instance<T>::Get()
+    {
+        return _value;
+    }
+
+    template <typename T>
+    const T& Instance<T>::Get() const
+    {
+        return _value;
+    }
+
+    template <typename T>
+    const std::shared_ptr<const ClassInfo<T>>& Instance<T>::GetInfo() const
+    {
+        return _info;
+    }
+
+    template <typename T>
+    ClassPrototype<T>::ClassPrototype(const std::shared_ptr<const ClassInfo<T>>& info) : Prototype({}), _info(info)
+    {
+    }
+
+    template <typename T>
+    void ClassPrototype<T>::Init()
+    {
+        Prototype::Init();
+        _construct = runtime::makeObject<runtime::FastNativeFunction>(std::shared_ptr<runtime::ScopeLike>{},_info->name,_info->constructorParams,
+            _info->constructor ? _info->constructor : &detail::notConstructible<T>);
+        _construct->SetOwner(this->GetRef());
+        Set(runtime::ReservedDynamicFunctions::CALL,_construct);
+    }
+
+    template <typename T>
+    std::string ClassPrototype<T>::ToString(const std::shared_ptr<runtime::ScopeLike>& scope) const
+    {
+        return "<Prototype : " + _info->name + ">";
+    }
+
+    template <typename T>
+    std::shared_ptr<runtime::DynamicObject> ClassPrototype<T>::CreateInstance(std::shared_ptr<runtime::FunctionScope>& scope)
+    {
+        return cast<runtime::DynamicObject>(_construct->HandleCall(scope));
+    }
+
+    template <typename T>
+    std::string ClassPrototype<T>::GetName() const
+    {
+        return _info->name;
+    }
+
+    template <typename T>
+    const std::shared_ptr<const ClassInfo<T>>& ClassPrototype<T>::GetInfo() const
+    {
+        return _info;
+    }
+
+    template <typename T>
+    Class<T>::Class(const std::string& name) : _info(std::make_shared<ClassInfo<T>>())
+    {
+        _info->name = name;
+        if constexpr (std::is_default_constructible_v<T>)
+        {
+            _info->constructor = &detail::constructThunk<T>;
+        }
+    }
+
+    template <typename T>
+    template <auto Fn>
+    Class<T>& Class<T>::Method(const std::string& name, const std::vector<std::string>& params)
+    {
+        _info->methods.Add(name,params,&detail::methodThunk<T,Fn>);
+        return *this;
+    }
+
+    template <typename T>
+    template <typename ... TArgs>
+    Class<T>& Class<T>::Constructor(const std::vector<std::string>& params)
+    {
+        _info->constructorParams = params;
+        _info->constructor = &detail::constructThunk<T,TArgs...>;
+        return *this;
+    }
+
+    template <typename T>
+    std::shared_ptr<ClassPrototype<T>> Class<T>::GetPrototype() const
+    {
+        if(!_prototype)
+        {
+            _prototype = runtime::makeObject<ClassPrototype<T>>(_info);
+        }
+
+        return _prototype;
+    }
+
+    template <typename T>
+    template <typename ... TArgs>
+    std::shared_ptr<Instance<T>> Class<T>::New(TArgs&&... args) const
+    {
+        return runtime::makeObject<Instance<T>>(_info,std::forward<TArgs>(args)...);
+    }
+
+    template <typename T>
+    std::string Class<T>::GetName() const
+    {
+        return _info->name;
+    }
+
+    template <typename T>
+    T* getNative(const std::shared_ptr<runtime::Object>& obj)
+    {
+        if(const auto instance = dynamic_cast<Instance<T>*>(runtime::resolveReference(obj).get()))
+        {
+            return &instance->Get();
+        }
+
+        return nullptr;
+    }
+}
@@ -47,6 +47,7 @@ namespace spp::frontend
         Try,
         Catch,
         Arrow,
-        Colon
+        Colon,
+        In
     };
 }
\ No newline at end of file
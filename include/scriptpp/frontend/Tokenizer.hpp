@@ -12,6 +12,8 @@ namespace spp::frontend
 {
     std::optional<Token> joinTokensTill(TokenList& tokens,const std::set<std::string>& search);
     
+    bool isWordChar(char c);
+    
     bool isSplitToken(const Token& token);
     
     bool isSeparatorToken(const Token& token);
@@ -1,4 +1,5 @@
 ﻿#pragma once
 #include "parser.hpp"
+#include "resolver.hpp"
 #include "Token.hpp"
 #include "tokenizer.hpp"
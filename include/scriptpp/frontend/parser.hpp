@@ -1,11 +1,16 @@
 ﻿#pragma once
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "Token.hpp"
 #include "TokenList.hpp"
 
+namespace spp::runtime
+{
+    class String;
+}
 
 namespace spp::frontend
 {
@@ -30,6 +35,7 @@ namespace spp::frontend
         When,
         Scope,
         For,
+        ForIn,
         While,
         Break,
         Continue,
@@ -119,6 +125,10 @@ namespace spp::frontend
     {
         std::string value;
 
+        // Interned by the evaluator the first time the literal runs, later runs reuse it without touching the intern table
+        std::once_flag internOnce;
+        std::shared_ptr<runtime::String> interned;
+
         StringLiteralNode(const TokenDebugInfo& inDebugInfo,const std::string& inValue);
     };
 
@@ -238,6 +248,13 @@ namespace spp::frontend
         std::vector<std::shared_ptr<ParameterNode>> params;
         std::shared_ptr<ScopeNode> body;
 
+        // Filled in from the body when the node is made, see findFreeVariables
+        std::vector<std::string> freeVariables;
+
+        // Free variables declared by an enclosing function, class or block, filled in when that is parsed. See
+        // markEnclosingVariables
+        std::vector<std::string> enclosingVariables;
+
         FunctionNode(const TokenDebugInfo& inDebugInfo,const std::string& inName, const std::vector<std::shared_ptr<ParameterNode>>& inParams,const std::shared_ptr<ScopeNode>& inBody);
         
     };
@@ -262,6 +279,17 @@ namespace spp::frontend
         
     };
 
+    // for (let item in iterable) { }
+    struct ForInNode : Node
+    {
+        std::string id;
+        std::shared_ptr<Node> iterable;
+        std::shared_ptr<ScopeNode> body;
+
+        ForInNode(const TokenDebugInfo& inDebugInfo,const std::string& inId,const std::shared_ptr<Node>& inIterable,const std::shared_ptr<ScopeNode>& inBody);
+        
+    };
+
     struct WhileNode : Node
     {
         std::shared_ptr<Node> condition;
@@ -314,7 +342,7 @@ namespace spp::frontend
 
     std::shared_ptr<ReturnNode> parseReturn(TokenList &tokens);
 
-    std::shared_ptr<ForNode> parseFor(TokenList &tokens);
+    std::shared_ptr<Node> parseFor(TokenList &tokens);
 
     std::shared_ptr<WhileNode> parseWhile(TokenList &tokens);
 
@@ -0,0 +1,22 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace spp::frontend
+{
+    struct Node;
+    struct ParameterNode;
+    struct ScopeNode;
+
+    // Names a function body looks up outside of its own parameters, sorted. Nested functions contribute the names they
+    // look up themselves, so a function's list covers every closure inside it. Members named after a dot are skipped,
+    // anything else that could name a variable is kept so the list never misses one
+    std::vector<std::string> findFreeVariables(const std::vector<std::shared_ptr<ParameterNode>>& params,const std::shared_ptr<ScopeNode>& body);
+
+    // Records on every function inside nodes, however deeply nested, which of its free variables are declared by the
+    // function, class or module these nodes belong to. Those may be declared after the closure is made, so the
+    // closure can't skip the scopes they will be declared in. Declarations made directly by the statements of a
+    // module are left out when topLevel is set, a closure never skips the module scope
+    void markEnclosingVariables(const std::vector<std::shared_ptr<Node>>& nodes,const std::vector<std::shared_ptr<ParameterNode>>& params = {},bool topLevel = false);
+}
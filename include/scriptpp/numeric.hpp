@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+// Numeric kernels over packed list storage.
+// Floating point sums and dot products pick AVX2 at runtime when the CPU has it, SSE2 otherwise.
+// Integer kernels check for overflow once per block, blocks whose items are small enough to never overflow run a plain
+// loop the compiler can vectorize. Kernels that do overflow return false, callers redo the work in doubles.
+namespace spp::numeric
+{
+    bool sum(std::span<const int64_t> items, int64_t& result);
+
+    double sum(std::span<const double> items);
+
+    int64_t min(std::span<const int64_t> items);
+
+    double min(std::span<const double> items);
+
+    int64_t max(std::span<const int64_t> items);
+
+    double max(std::span<const double> items);
+
+    bool dot(std::span<const int64_t> a, std::span<const int64_t> b, int64_t& result);
+
+    double dot(std::span<const double> a, std::span<const double> b);
+
+    // out[i] = items[i] * factor, out must be at least as large as items
+    bool scale(std::span<const int64_t> items, int64_t factor, std::span<int64_t> out);
+
+    void scale(std::span<const double> items, double factor, std::span<double> out);
+
+    // out[i] = a[i] + b[i], all spans must have the same size
+    bool add(std::span<const int64_t> a, std::span<const int64_t> b, std::span<int64_t> out);
+
+    void add(std::span<const double> a, std::span<const double> b, std::span<double> out);
+}
@@ -1,22 +1,27 @@
 ﻿#pragma once
 #include "DynamicObject.hpp"
+#include "ObjectMap.hpp"
 #include "Prototype.hpp"
 
 namespace spp::runtime
 {
     class DictionaryPrototype;
+    class Iterator;
     
     class Dictionary : public DynamicObject
     {
-        std::unordered_map<std::shared_ptr<Object>,std::shared_ptr<Object>> _entries{};
+        ObjectMap _entries{};
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<Function> BindNativeMethod(const std::string& id) const override;
     public:
         Dictionary();
         
         Dictionary(const std::unordered_map<std::shared_ptr<Object>,std::shared_ptr<Object>>& data);
         
         static std::shared_ptr<DictionaryPrototype> Prototype;
-        
-        void Init() override;
+
+        static const NativeMethodTable<Dictionary>& GetMethods();
 
         std::shared_ptr<Object> PutItem(const std::shared_ptr<FunctionScope>& fnScope);
 
@@ -24,11 +29,69 @@ namespace spp::runtime
         
         std::shared_ptr<Object> HasItem(const std::shared_ptr<FunctionScope>& fnScope);
 
+        std::shared_ptr<Object> RemoveItem(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Size(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Clear(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Update(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Reserve(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Keys(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Values(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Items(const std::shared_ptr<FunctionScope>& fnScope);
+
+        // Copies entries from another dictionary or a list of [key , value] pairs, reserving once up front
+        void Merge(const std::shared_ptr<Object>& source,const std::shared_ptr<ScopeLike>& scope);
+
         std::shared_ptr<Object> Get(const std::shared_ptr<Object>& key, const std::shared_ptr<ScopeLike>& scope) const override;
 
+        void Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& val, const std::shared_ptr<ScopeLike>& scope) override;
+
+        using DynamicObject::Set;
+
+        ObjectMap& GetNative();
+
         std::string ToString(const std::shared_ptr<ScopeLike>&) const override;
     };
     
+    enum class EDictionaryView
+    {
+        Keys,
+        Values,
+        Items
+    };
+
+    // Live view over a dictionary, nothing is copied and every iteration sees the current entries
+    class DictionaryView : public DynamicObject
+    {
+        std::shared_ptr<Dictionary> _dict;
+        EDictionaryView _view;
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<Function> BindNativeMethod(const std::string& id) const override;
+    public:
+        DictionaryView(const std::shared_ptr<Dictionary>& dict,EDictionaryView view);
+
+        static const NativeMethodTable<DictionaryView>& GetMethods();
+
+        std::shared_ptr<Iterator> MakeIterator() const;
+
+        std::shared_ptr<Object> Iter(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Size(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Has(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
+    };
+
+    std::shared_ptr<Iterator> makeDictionaryIterator(const std::shared_ptr<Dictionary>& dict,EDictionaryView view);
+
     std::shared_ptr<Dictionary> makeDictionary(const std::unordered_map<std::shared_ptr<Object>,std::shared_ptr<Object>>& data);
     std::shared_ptr<Dictionary> makeDictionary(const std::unordered_map<std::string,std::shared_ptr<Object>>& data);
     std::shared_ptr<Dictionary> makeDictionary();
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Function.hpp"
+#include "NativeCall.hpp"
 #include "Object.hpp"
 #include "Scope.hpp"
 
@@ -34,6 +35,13 @@ namespace spp::runtime
         std::shared_ptr<ScopeLike> _outer;
         std::unordered_map<std::string,std::shared_ptr<Object>> _properties;
         std::shared_ptr<ScopeLike> _selfFunctionScope;
+
+        // Created on first use so objects that never add members don't pay for it
+        std::shared_ptr<ScopeLike> GetSelfScope();
+
+        // Native types override these to expose methods shared by every instance (see NativeMethodTable)
+        virtual bool HasNativeMethod(const std::string& id) const;
+        virtual std::shared_ptr<Function> BindNativeMethod(const std::string& id) const;
     public:
 
         void Init() override;
@@ -57,7 +65,7 @@ namespace spp::runtime
         void Create(const std::string& id, const std::shared_ptr<Object>& var) override;
         std::shared_ptr<Object> Find(const std::string& id, bool searchParent = true) const override;
 
-        std::list<EScopeType> GetScopeStack() const override;
+        ScopeTypeMask GetScopeMask() const override;
         bool HasScopeType(EScopeType type) const override;
         EScopeType GetScopeType() const override;
         EObjectType GetType() const override;
@@ -87,6 +95,9 @@ namespace spp::runtime
         
         void AddLambda(const std::string& name,const std::vector<std::string>& args,const std::function<std::shared_ptr<Object>(std::shared_ptr<FunctionScope>&)>& func);
 
+        // Like AddLambda for natives on the frameless ABI, see bindNative
+        void AddNative(const std::string& name,const std::vector<std::string>& args,NativeFunctionPointer func);
+
         std::shared_ptr<ScopeLike> GetOuter() const override;
 
         bool Equal(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope) const override;
@@ -107,28 +118,120 @@ namespace spp::runtime
     void DynamicObject::AddNativeMemberFunction(const std::string& name, T* instance,const std::vector<std::string>& params,
         TNativeDynamicMemberFunction<T> func)
     {
-        AddNativeMemberFunction(name, makeNativeFunction(_selfFunctionScope, name, params,std::bind(func,instance,std::placeholders::_1),false));
+        AddNativeMemberFunction(name, makeNativeFunction(GetSelfScope(), name, params,std::bind(func,instance,std::placeholders::_1),false));
     }
 
     template <typename T>
     void DynamicObject::AddNativeMemberFunction(const std::string& name, T* instance, const std::vector<std::string>& params,
         TNativeDynamicMemberFunctionConst<T> func)
     {
-        AddNativeMemberFunction(name, makeNativeFunction(_selfFunctionScope, name, params,std::bind(func,instance,std::placeholders::_1),false));
+        AddNativeMemberFunction(name, makeNativeFunction(GetSelfScope(), name, params,std::bind(func,instance,std::placeholders::_1),false));
     }
 
     template <typename T>
     void DynamicObject::AddNativeMemberFunction(const std::string& name, T* instance,const std::vector<std::shared_ptr<frontend::ParameterNode>>& params,
         TNativeDynamicMemberFunction<T> func)
     {
-        AddNativeMemberFunction(name, makeNativeFunction(_selfFunctionScope, name, params,std::bind(func,instance,std::placeholders::_1),false));
+        AddNativeMemberFunction(name, makeNativeFunction(GetSelfScope(), name, params,std::bind(func,instance,std::placeholders::_1),false));
     }
 
     template <typename T>
     void DynamicObject::AddNativeMemberFunction(const std::string& name, T* instance, const std::vector<std::shared_ptr<frontend::ParameterNode>>& params,
         TNativeDynamicMemberFunctionConst<T> func)
     {
-        AddNativeMemberFunction(name, makeNativeFunction(_selfFunctionScope, name, params,std::bind(func,instance,std::placeholders::_1),false));
+        AddNativeMemberFunction(name, makeNativeFunction(GetSelfScope(), name, params,std::bind(func,instance,std::placeholders::_1),false));
+    }
+
+    // Methods shared by every instance of a native type, functions are only bound to an instance when accessed
+    template<typename T>
+    class NativeMethodTable
+    {
+    public:
+        using Method = DynamicObject::TNativeDynamicMemberFunctionConst<T>;
+
+        // Either method or native is set, natives are called without a frame
+        struct Entry
+        {
+            std::vector<std::shared_ptr<frontend::ParameterNode>> params;
+            std::shared_ptr<const ParameterLayout> layout;
+            Method method;
+            NativeFunctionPointer native;
+        };
+
+        NativeMethodTable& Add(const std::string& name,const std::vector<std::string>& params,Method method);
+
+        // Methods on the frameless ABI, usually made with bindNative<&T::Method>()
+        NativeMethodTable& Add(const std::string& name,const std::vector<std::string>& params,NativeFunctionPointer native);
+
+        bool Has(const std::string& name) const;
+
+        std::shared_ptr<Function> Bind(const std::string& name,const T * instance) const;
+
+    private:
+        std::unordered_map<std::string,Entry> _methods;
+    };
+
+    template <typename T>
+    NativeMethodTable<T>& NativeMethodTable<T>::Add(const std::string& name, const std::vector<std::string>& params,
+        Method method)
+    {
+        Entry entry{{},{},method,nullptr};
+        entry.params.reserve(params.size());
+        for (auto &param : params)
+        {
+            entry.params.push_back(std::make_shared<frontend::ParameterNode>(frontend::TokenDebugInfo{},param));
+        }
+        _methods.insert_or_assign(name,entry);
+        return *this;
+    }
+
+    template <typename T>
+    NativeMethodTable<T>& NativeMethodTable<T>::Add(const std::string& name, const std::vector<std::string>& params,
+        NativeFunctionPointer native)
+    {
+        Entry entry{{},{},nullptr,native};
+        entry.params.reserve(params.size());
+        for (auto &param : params)
+        {
+            entry.params.push_back(std::make_shared<frontend::ParameterNode>(frontend::TokenDebugInfo{},param));
+        }
+        entry.layout = std::make_shared<ParameterLayout>(entry.params);
+        _methods.insert_or_assign(name,entry);
+        return *this;
+    }
+
+    template <typename T>
+    bool NativeMethodTable<T>::Has(const std::string& name) const
+    {
+        return _methods.contains(name);
+    }
+
+    template <typename T>
+    std::shared_ptr<Function> NativeMethodTable<T>::Bind(const std::string& name, const T* instance) const
+    {
+        const auto it = _methods.find(name);
+        if(it == _methods.end())
+        {
+            return {};
+        }
+
+        const auto self = castStatic<T>(instance->GetRef());
+        if(it->second.native)
+        {
+            // The function holds the instance itself, no capture or scope proxy is needed
+            auto fn = makeObject<FastNativeFunction>(std::shared_ptr<ScopeLike>{},name,it->second.params,it->second.layout,it->second.native);
+            fn->SetOwner(self);
+            fn->SetSelf(self);
+            return fn;
+        }
+
+        const auto method = it->second.method;
+        auto fn = makeNativeFunction(makeRefScopeProxy(self),name,it->second.params,[self,method](std::shared_ptr<FunctionScope>& scope)
+        {
+            return (self.get()->*method)(scope);
+        },false);
+        fn->SetOwner(self);
+        return fn;
     }
 
     class DynamicObjectReference : public Reference
@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+namespace spp::runtime
+{
+    // Per-thread stack of finished call frames. A frame is only taken back when the caller holds the last reference to
+    // it, frames captured by closures or escaping references stay alive on the heap as before. T needs a Release()
+    // that drops everything the frame points at
+    template<typename T>
+    class FramePool
+    {
+        std::vector<std::shared_ptr<T>> _free{};
+    public:
+        static constexpr size_t MAX_FREE = 256;
+
+        static FramePool& Get();
+
+        // Returns a released frame or nullptr when the pool is empty
+        std::shared_ptr<T> Take();
+
+        void Return(std::shared_ptr<T>&& frame);
+    };
+
+    template <typename T>
+    FramePool<T>& FramePool<T>::Get()
+    {
+        thread_local FramePool pool{};
+        return pool;
+    }
+
+    template <typename T>
+    std::shared_ptr<T> FramePool<T>::Take()
+    {
+        if(_free.empty())
+        {
+            return {};
+        }
+
+        auto frame = std::move(_free.back());
+        _free.pop_back();
+        return frame;
+    }
+
+    template <typename T>
+    void FramePool<T>::Return(std::shared_ptr<T>&& frame)
+    {
+        if(frame && frame.use_count() == 1 && _free.size() < MAX_FREE)
+        {
+            frame->Release();
+            _free.push_back(std::move(frame));
+        }
+
+        frame.reset();
+    }
+}
@@ -1,6 +1,8 @@
-#pragma once
+﻿#pragma once
 #include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 #include "Object.hpp"
@@ -10,16 +12,52 @@
 namespace spp::runtime
 {
     class Function;
+
+    using NamedArguments = std::vector<std::pair<std::string,std::shared_ptr<Object>>>;
+
+    // Parameter names in slot order, built once per function and shared by all of its calls
+    struct ParameterLayout
+    {
+        std::vector<std::string> names;
+
+        explicit ParameterLayout(const std::vector<std::shared_ptr<frontend::ParameterNode>>& params);
+
+        // Returns the slot of the parameter called id or -1
+        int32_t FindSlot(const std::string& id) const;
+    };
+
+    // Call made by `return f(...)`, it is left in the returning frame and made once that frame is done
+    struct TailCall
+    {
+        std::shared_ptr<Function> fn{};
+        std::vector<std::shared_ptr<Object>> positionalArgs{};
+        NamedArguments namedArgs{};
+        std::shared_ptr<CallScope> callScope{};
+    };
     
     class FunctionScope : public Scope
     {
-        std::unordered_map<std::string,std::shared_ptr<Object>> _arguments{};
-        std::vector<std::shared_ptr<Object>> _positionalArguments{};
+        std::shared_ptr<const ParameterLayout> _layout{};
+
+        // Positional arguments followed by the slots of parameters that were not passed positionally
+        std::vector<std::shared_ptr<Object>> _arguments{};
+        size_t _positionalCount = 0;
+        NamedArguments _namedArguments{};
+
+        // __args__ and __nargs__ are only built the first time the body looks them up
+        mutable std::shared_ptr<Object> _argumentsList{};
+        mutable std::shared_ptr<Object> _namedArgumentsDict{};
+
+        std::shared_ptr<Object> FindImplicit(const std::string& id) const;
+
+        void Bind(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<const ParameterLayout>& layout);
+        void Bind(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<const ParameterLayout>& layout,std::vector<std::shared_ptr<Object>>&& positionalArgs,NamedArguments&& namedArgs);
         std::shared_ptr<Object> _result{};
         std::weak_ptr<Function> _fn{};
         std::shared_ptr<Object> _functionOwner{};
         std::shared_ptr<ScopeLike> _callerScope{};
         std::shared_ptr<ScopeLike> _ownerScope{};
+        std::optional<TailCall> _tailCall{};
         
     public:
 
@@ -29,43 +67,96 @@ namespace spp::runtime
         
         static std::string THIS_KEY;
         
-        FunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::vector<std::shared_ptr<frontend::ParameterNode>>& parameters,const std::unordered_map<std::string,std::shared_ptr<Object>>& args,const std::vector<std::shared_ptr<Object>>& positionalArgs);
-
-        EScopeType GetScopeType() const override;
+        FunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout);
+        FunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout,std::vector<std::shared_ptr<Object>>&& positionalArgs,NamedArguments&& namedArgs);
 
         std::shared_ptr<Object> Find(const std::string& id, bool searchParent = true) const override;
 
+        bool Has(const std::string& id, bool searchParent = true) const override;
+
+        // Parameters are written to their slot, everything else goes to the scope
+        void Assign(const std::string& id, const std::shared_ptr<Object>& var) override;
+
+        void Create(const std::string& id, const std::shared_ptr<Object>& var) override;
+
+        void SetSlot(size_t slot,const std::shared_ptr<Object>& var);
+
         std::shared_ptr<Object> FindArgument(const std::string& id,bool required = false);
 
         std::shared_ptr<Object> GetArgument(const uint32_t& index);
 
         virtual std::weak_ptr<Function> GetFunction() const;
 
-        virtual std::unordered_map<std::string,std::shared_ptr<Object>> GetNamedArgs() const;
+        // Arguments as they were passed, both stay valid until the frame is released
+        virtual const NamedArguments& GetNamedArgs() const;
 
-        virtual std::vector<std::shared_ptr<Object>> GetPositionalArgs() const;
+        virtual std::span<const std::shared_ptr<Object>> GetPositionalArgs() const;
+
+        // Empty argument storage of a frame made without arguments, call sites evaluate their arguments straight into
+        // it and then call BindArguments. Pooled frames keep the capacity of their last call
+        std::vector<std::shared_ptr<Object>>& GetArgumentStorage();
+
+        NamedArguments& GetNamedArgumentStorage();
+
+        // Places the named arguments in the slots of the parameters that were not passed positionally
+        void BindArguments();
 
         std::shared_ptr<ScopeLike> GetCallerScope() const;
 
+        void SetResult(const std::shared_ptr<Object>& result);
+
+        // Returns the value set by the last return statement and clears the slot
+        std::shared_ptr<Object> TakeResult();
+
+        void SetTailCall(TailCall&& tailCall);
+
+        // Moves the pending tail call into out, returns false when there is none
+        bool TakeTailCall(TailCall& out);
+
+        // Sets up a pooled frame for a new call
+        void Reset(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout);
+        void Reset(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout,std::vector<std::shared_ptr<Object>>&& positionalArgs,NamedArguments&& namedArgs);
+
+        // Called by FramePool before the frame is stored for reuse
+        void Release();
+
     };
 
-    std::shared_ptr<FunctionScope> makeFunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::vector<std::shared_ptr<frontend::ParameterNode>>& parameters,const std::unordered_map<std::string,std::shared_ptr<Object>>& args,const std::vector<std::shared_ptr<Object>>& positionalArgs);
+    // Finds the function scope a return statement in this scope belongs to
+    std::shared_ptr<FunctionScope> findFunctionScope(const std::shared_ptr<ScopeLike>& scope);
+
+    // Reuses a frame from this thread's pool when one is free, hand it back with releaseFunctionScope
+    std::shared_ptr<FunctionScope> makeFunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout,std::vector<std::shared_ptr<Object>>&& positionalArgs,NamedArguments&& namedArgs);
+
+    // Same, but the arguments are left for the caller to fill with GetArgumentStorage
+    std::shared_ptr<FunctionScope> makeFunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout);
+
+    void releaseFunctionScope(std::shared_ptr<FunctionScope>&& scope);
+
+    // Makes tailCall and every tail call it leaves behind one after another, returns the result of the last one
+    std::shared_ptr<Object> runTailCalls(TailCall&& tailCall);
     
     class Function : public Object
     {
         std::string _name{};
          std::vector<std::shared_ptr<frontend::ParameterNode>> _params{};
+        std::shared_ptr<const ParameterLayout> _layout{};
         std::shared_ptr<ScopeLike> _declarationScope{};
         std::weak_ptr<Object> _owner{};
     public:
         Function(const std::shared_ptr<ScopeLike>& declarationScope,const std::string& name,const  std::vector<std::shared_ptr<frontend::ParameterNode>>& params);
         Function(const std::shared_ptr<ScopeLike>& declarationScope,const std::string& name,const  std::vector<std::string>& params);
+        // Shares a layout built once, for functions that are bound over and over
+        Function(const std::shared_ptr<ScopeLike>& declarationScope,const std::string& name,const  std::vector<std::shared_ptr<frontend::ParameterNode>>& params,const std::shared_ptr<const ParameterLayout>& layout);
         EObjectType GetType() const override;
         bool ToBoolean(const std::shared_ptr<ScopeLike>& scope) const override;
         std::string ToString(const std::shared_ptr<ScopeLike>& scope = {}) const override;
 
-        virtual std::shared_ptr<Object> Call(const std::vector<std::shared_ptr<Object>>& positionalArgs = {}, const
-                                             std::unordered_map<std::string, std::shared_ptr<Object>>& namedArgs = {},const std::shared_ptr<ScopeLike>& callScope = {});
+        virtual std::shared_ptr<Object> Call(std::vector<std::shared_ptr<Object>> positionalArgs = {},NamedArguments namedArgs = {},const std::shared_ptr<ScopeLike>& callScope = {});
+
+        // True when Call only builds a frame and runs HandleCall, call sites can then build the frame themselves.
+        // Functions overriding Call to run without a frame return false
+        virtual bool IsCalledThroughFrame() const;
 
         template<typename ...TArgs, typename = std::enable_if_t<((std::is_convertible_v<TArgs, std::shared_ptr<Object>>) && ...)>>
         std::shared_ptr<Object> Call(const std::shared_ptr<ScopeLike>& callerScope,TArgs... args);
@@ -79,6 +170,8 @@ namespace spp::runtime
 
         std::shared_ptr<ScopeLike> GetDeclarationScope() const;
 
+        std::shared_ptr<const ParameterLayout> GetLayout() const;
+
         bool IsCallable() const override;
 
         std::string GetName() const;
@@ -96,8 +189,9 @@ namespace spp::runtime
     std::shared_ptr<Object> Function::Call(const std::shared_ptr<ScopeLike>& callerScope,TArgs... args)
     {
         std::vector<std::shared_ptr<Object>> vecArgs{};
+        vecArgs.reserve(sizeof...(TArgs));
         (vecArgs.push_back(args),...);
-        return Call(vecArgs,{},callerScope);
+        return Call(std::move(vecArgs),{},callerScope);
     }
 
     class RuntimeFunction : public Function
@@ -107,9 +201,14 @@ namespace spp::runtime
     public:
         RuntimeFunction(const std::shared_ptr<ScopeLike>& scope,const std::shared_ptr<frontend::FunctionNode>& function);
 
+        // Runs the body once, a tail call it returns is left in scope
+        std::shared_ptr<Object> RunBody(std::shared_ptr<FunctionScope>& scope);
+
         std::shared_ptr<Object> HandleCall(std::shared_ptr<FunctionScope>& scope) override;
 
         std::shared_ptr<Function> Clone() override;
+
+        std::shared_ptr<frontend::FunctionNode> GetNode() const;
     };
 
     using NativeFunctionType = std::function<std::shared_ptr<Object>(std::shared_ptr<FunctionScope>&)>;
@@ -126,6 +225,12 @@ namespace spp::runtime
         std::shared_ptr<Function> Clone() override;
     };
     
+    // The scope a closure declared in scope has to keep alive: the innermost one holding one of its free variables, so
+    // frames and blocks in between are freed with their variables once they are done. The module scope is never
+    // skipped. Falls back to scope itself when a name is not defined yet or an enclosing function, class or block
+    // declares it, it may be declared there after the closure is made
+    std::shared_ptr<ScopeLike> findCaptureScope(const std::shared_ptr<ScopeLike>& scope,const frontend::FunctionNode& function);
+
     std::shared_ptr<RuntimeFunction> makeRuntimeFunction(const std::shared_ptr<ScopeLike>& scope,const std::shared_ptr<frontend::FunctionNode>& function,bool addToScope = true);
 
     std::shared_ptr<NativeFunction> makeNativeFunction(const std::shared_ptr<ScopeLike>& scope,const std::string& name, const std::vector<std::string>& params,const NativeFunctionType& nativeFunction,bool addToScope = true);
@@ -0,0 +1,35 @@
+#pragma once
+#include "DynamicObject.hpp"
+
+namespace spp::runtime
+{
+    // Lazy sequence, every stage pulls one value at a time from the stage before it so chains never build intermediate lists
+    class Iterator : public DynamicObject
+    {
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<Function> BindNativeMethod(const std::string& id) const override;
+    public:
+        Iterator();
+
+        // Stores the next value in value, returns false once the sequence is exhausted
+        virtual bool Next(std::shared_ptr<Object>& value,const std::shared_ptr<ScopeLike>& scope) = 0;
+
+        std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
+
+        std::shared_ptr<Object> Iter(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Map(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Filter(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Take(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Skip(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Zip(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Enumerate(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Collect(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> NextValue(const std::shared_ptr<FunctionScope>& fnScope);
+
+        static const NativeMethodTable<Iterator>& GetMethods();
+    };
+
+    // Iterates lists, tuples, strings, dictionaries, iterators and objects with an iter() method
+    std::shared_ptr<Iterator> makeIterator(const std::shared_ptr<Object>& source,const std::shared_ptr<ScopeLike>& scope);
+}
@@ -18,12 +18,61 @@ namespace spp::runtime
 
         void Set(const std::shared_ptr<Object>& val) override;
     };
+    // How a list holds its items, packed storage keeps raw values instead of one heap object per item
+    enum class EListStorage
+    {
+        Objects,
+        Int64,
+        Double,
+        Boolean
+    };
+    
     class List : public DynamicObject
     {
+        EListStorage _storage = EListStorage::Objects;
         std::vector<std::shared_ptr<Object>> _vec;
+        std::vector<int64_t> _ints;
+        std::vector<double> _doubles;
+        std::vector<bool> _bools;
+
+        // Switches to packed storage if every item is the same kind of value
+        void Pack();
+
+        // Switches back to generic storage, called before storing a value the packed storage can't hold
+        void Unpack();
+
+        void CheckIndex(int64_t index,const std::shared_ptr<ScopeLike>& scope) const;
+
+        bool TryStorePacked(size_t index,const std::shared_ptr<Object>& val);
+        bool TryAppendPacked(const std::shared_ptr<Object>& val);
+
+        bool IsPackedNumeric() const;
+
+        // Copies packed numbers as doubles, used when mixing integer and floating point lists
+        std::vector<double> GetDoubles() const;
+
+        std::shared_ptr<List> FindListArg(const std::shared_ptr<FunctionScope>& fnScope,const std::string& id) const;
+
+        template<typename T>
+        static void ApplyOrder(std::vector<T>& items,const std::vector<size_t>& order,const std::shared_ptr<ScopeLike>& scope);
+
+        // Stable sort that stays in bounds whatever less returns, used for comparisons that run script code
+        static void MergeSort(std::vector<size_t>& order,const std::function<bool(size_t,size_t)>& less);
+
+        // Sorts a permutation of the indices with less and then reorders whichever storage is active. Untrusted
+        // comparisons may be inconsistent or modify the list and always go through MergeSort
+        void SortWith(const std::function<bool(size_t,size_t)>& less,bool stable,bool trusted,const std::shared_ptr<ScopeLike>& scope);
+
+        // Sorts items by keys[i], using native comparisons when every key is a number or every key is a string
+        void SortByKeys(const std::vector<std::shared_ptr<Object>>& keys,bool stable,const std::shared_ptr<ScopeLike>& scope);
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<Function> BindNativeMethod(const std::string& id) const override;
     public:
-        void Init() override;
         List(const std::vector<std::shared_ptr<Object>>& vec);
+        List(std::vector<int64_t>&& vec);
+        List(std::vector<double>&& vec);
+        List(std::vector<bool>&& vec);
         std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
         bool ToBoolean(const std::shared_ptr<ScopeLike>& scope) const override;
 
@@ -32,21 +81,44 @@ namespace spp::runtime
         void Set(const std::string& key, const std::shared_ptr<Object>& val) override;
         virtual void Set(const size_t& index,const std::shared_ptr<Object>& val);
 
-        std::shared_ptr<Object> Push(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> Pop(const std::shared_ptr<FunctionScope>& fnScope);
+        EListStorage GetStorage() const;
+        size_t GetSize() const;
+        std::shared_ptr<Object> GetItem(size_t index) const;
+
+        // Bounds checked access for the evaluator, no reference is created
+        std::shared_ptr<Object> GetAt(int64_t index,const std::shared_ptr<ScopeLike>& scope) const;
+        void SetAt(int64_t index,const std::shared_ptr<Object>& val,const std::shared_ptr<ScopeLike>& scope);
+        void Append(const std::shared_ptr<Object>& val);
+
+        std::shared_ptr<Object> Push(NativeArgs items);
+        std::shared_ptr<Object> Pop(NativeCallContext& ctx);
         std::shared_ptr<Object> Map(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> ForEach(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> Filter(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> FindItem(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> FindIndex(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> Sort(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> Size(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> Join(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> Reverse(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> SortBy(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Join(const std::shared_ptr<Object>& delimiter,NativeCallContext& ctx) const;
+        std::shared_ptr<Object> Reverse() const;
+        std::shared_ptr<Object> Sum(NativeCallContext& ctx) const;
+        std::shared_ptr<Object> Min(NativeCallContext& ctx) const;
+        std::shared_ptr<Object> Max(NativeCallContext& ctx) const;
+        std::shared_ptr<Object> Mean(NativeCallContext& ctx) const;
+        std::shared_ptr<Object> Dot(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Scale(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> AddList(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> ParallelMap(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> ParallelFilter(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> ParallelForEach(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Iter(const std::shared_ptr<FunctionScope>& fnScope);
 
+        // Converts packed storage to objects, prefer GetItem/GetSize when only reading
         virtual std::vector<std::shared_ptr<Object>>& GetNative();
         static std::shared_ptr<ListPrototype> Prototype;
 
+        static const NativeMethodTable<List>& GetMethods();
+
         size_t GetHashCode(const std::shared_ptr<ScopeLike>& scope) override;
     };
 
@@ -55,10 +127,15 @@ namespace spp::runtime
     public:
         ListPrototype();
 
+        void Init() override;
+
         std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
 
         std::shared_ptr<DynamicObject> CreateInstance(std::shared_ptr<FunctionScope>& scope) override;
         std::string GetName() const override;
+
+        // List.range(end) or List.range(start,end,step), produces packed integers
+        std::shared_ptr<Object> Range(const std::shared_ptr<FunctionScope>& fnScope);
     };
 
 
@@ -66,5 +143,11 @@ namespace spp::runtime
     
     std::shared_ptr<List> makeList(const std::vector<std::shared_ptr<Object>>& items);
 
+    std::shared_ptr<List> makeList(std::vector<int64_t>&& items);
+
+    std::shared_ptr<List> makeList(std::vector<double>&& items);
+
+    std::shared_ptr<List> makeList(std::vector<bool>&& items);
+
     std::shared_ptr<ListItemReference> makeListReference(const List * list,uint32_t idx);
 }
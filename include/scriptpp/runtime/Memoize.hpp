@@ -0,0 +1,55 @@
+#pragma once
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "Function.hpp"
+
+namespace spp::runtime
+{
+    // Wraps a function and caches its results by argument value. Keys hash and compare the way dictionary keys do, once
+    // maxSize results are cached the least recently used one is dropped, a maxSize of 0 keeps every result
+    class MemoizedFunction : public Function
+    {
+        struct KeyHash
+        {
+            size_t operator()(const std::shared_ptr<Object>& key) const;
+        };
+
+        struct KeyEqual
+        {
+            bool operator()(const std::shared_ptr<Object>& a,const std::shared_ptr<Object>& b) const;
+        };
+
+        using Entry = std::pair<std::shared_ptr<Object>,std::shared_ptr<Object>>;
+
+        std::shared_ptr<Function> _fn;
+        size_t _maxSize;
+
+        // Most recently used first, the index points into the list so a hit only moves one node
+        std::mutex _mutex{};
+        std::list<Entry> _entries{};
+        std::unordered_map<std::shared_ptr<Object>,std::list<Entry>::iterator,KeyHash,KeyEqual> _index{};
+
+        // A single argument is its own key, anything else is packed into a tuple. Returns null when an argument could
+        // change after the call, e.g. a list or dictionary, those calls aren't cached
+        static std::shared_ptr<Object> MakeKey(const std::vector<std::shared_ptr<Object>>& positionalArgs,const NamedArguments& namedArgs);
+    public:
+        MemoizedFunction(const std::shared_ptr<Function>& fn,size_t maxSize);
+
+        std::shared_ptr<Object> HandleCall(std::shared_ptr<FunctionScope>& scope) override;
+
+        std::shared_ptr<Function> Clone() override;
+
+        const std::shared_ptr<Function>& GetWrapped() const;
+
+        size_t GetCacheSize();
+
+        void ClearCache();
+    };
+
+    std::shared_ptr<MemoizedFunction> makeMemoizedFunction(const std::shared_ptr<Function>& fn,size_t maxSize = 0);
+
+    // memoize(fn, maxSize), the native behind the global of the same name
+    std::shared_ptr<Object> memoize(const std::shared_ptr<FunctionScope>& fnScope);
+}
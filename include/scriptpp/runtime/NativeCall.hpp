@@ -0,0 +1,276 @@
+#pragma once
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "Function.hpp"
+
+namespace spp::runtime
+{
+    // Positional arguments of a native call, references are already resolved
+    using NativeArgs = std::span<const std::shared_ptr<Object>>;
+
+    class FastNativeFunction;
+
+    // What a native gets besides its arguments. No frame is built for the call unless the native asks for one
+    class NativeCallContext
+    {
+        FastNativeFunction& _fn;
+        NativeArgs _args;
+        const NamedArguments& _namedArgs;
+        const std::shared_ptr<ScopeLike>& _callScope;
+        std::shared_ptr<FunctionScope> _frame{};
+    public:
+        NativeCallContext(FastNativeFunction& fn,NativeArgs args,const NamedArguments& namedArgs,const std::shared_ptr<ScopeLike>& callScope);
+        ~NativeCallContext();
+
+        NativeCallContext(const NativeCallContext&) = delete;
+        NativeCallContext& operator=(const NativeCallContext&) = delete;
+
+        // The object a bound method was accessed on, null for free functions
+        std::shared_ptr<Object> GetSelf() const;
+
+        const std::shared_ptr<ScopeLike>& GetCallScope() const;
+
+        const NamedArguments& GetNamedArgs() const;
+
+        // Builds a frame for this call the first time it is asked for. Exceptions thrown with it list the native in
+        // the call stack and callbacks can be called from it
+        const std::shared_ptr<FunctionScope>& GetScope();
+    };
+
+    using NativeFunctionPointer = std::shared_ptr<Object>(*)(NativeArgs args,NativeCallContext& ctx);
+
+    // Native function called through a plain function pointer, calls from scripts skip the frame NativeFunction needs
+    class FastNativeFunction : public Function
+    {
+        NativeFunctionPointer _func;
+        std::shared_ptr<Object> _self{};
+    public:
+        FastNativeFunction(const std::shared_ptr<ScopeLike>& scope,const std::string& name,const std::vector<std::string>& params,NativeFunctionPointer func);
+        FastNativeFunction(const std::shared_ptr<ScopeLike>& scope,const std::string& name,const std::vector<std::shared_ptr<frontend::ParameterNode>>& params,const std::shared_ptr<const ParameterLayout>& layout,NativeFunctionPointer func);
+
+        std::shared_ptr<Object> Call(std::vector<std::shared_ptr<Object>> positionalArgs = {},NamedArguments namedArgs = {},const std::shared_ptr<ScopeLike>& callScope = {}) override;
+
+        bool IsCalledThroughFrame() const override;
+
+        std::shared_ptr<Object> HandleCall(std::shared_ptr<FunctionScope>& scope) override;
+
+        std::shared_ptr<Function> Clone() override;
+
+        // Keeps the instance a method was bound to alive for as long as the method is, so methods of temporaries
+        // and detached methods still reach it
+        void SetSelf(const std::shared_ptr<Object>& self);
+
+        // The bound instance, or the owner when none was set
+        std::shared_ptr<Object> GetSelf() const;
+    };
+
+    std::shared_ptr<FastNativeFunction> makeFastNativeFunction(const std::shared_ptr<ScopeLike>& scope,const std::string& name,const std::vector<std::string>& params,NativeFunctionPointer func,bool addToScope = true);
+
+    // Conversions used by bindNative, they throw a script exception when the argument has the wrong type
+    bool nativeToBoolean(const std::shared_ptr<Object>& arg,NativeCallContext& ctx);
+    int64_t nativeToInteger(const std::shared_ptr<Object>& arg,NativeCallContext& ctx);
+    double nativeToDouble(const std::shared_ptr<Object>& arg,NativeCallContext& ctx);
+    std::string nativeToString(const std::shared_ptr<Object>& arg,NativeCallContext& ctx);
+    [[noreturn]] void throwNativeArgumentError(NativeCallContext& ctx,size_t index);
+
+    std::shared_ptr<Object> nativeResult(bool value);
+    std::shared_ptr<Object> nativeResult(int64_t value);
+    std::shared_ptr<Object> nativeResult(double value);
+    std::shared_ptr<Object> nativeResult(const std::string& value);
+
+    namespace detail
+    {
+        template<typename T>
+        using NativeBare = std::remove_cvref_t<T>;
+
+        // Parameters that are not taken from the argument list
+        template<typename T>
+        constexpr bool isNativeContext = std::is_same_v<NativeBare<T>,NativeCallContext>;
+
+        template<typename T>
+        constexpr bool isNativeRest = std::is_same_v<NativeBare<T>,NativeArgs>;
+
+        template<typename T>
+        struct IsSharedPtr : std::false_type {};
+
+        template<typename T>
+        struct IsSharedPtr<std::shared_ptr<T>> : std::true_type
+        {
+            using Element = T;
+        };
+
+        // Index into the arguments for every parameter, the context does not take one and the rest span starts there
+        template<typename ...TArgs>
+        constexpr std::array<size_t,sizeof...(TArgs)> nativeArgumentSlots()
+        {
+            std::array<size_t,sizeof...(TArgs)> slots{};
+            [[maybe_unused]] size_t next = 0;
+            size_t i = 0;
+            ((slots[i++] = next, next += isNativeContext<TArgs> ? 0 : 1),...);
+            return slots;
+        }
+
+        template<typename T>
+        decltype(auto) nativeArgument(NativeArgs args,size_t index,NativeCallContext& ctx)
+        {
+            using Bare = NativeBare<T>;
+            if constexpr (isNativeContext<T>)
+            {
+                return (ctx);
+            }
+            else if constexpr (isNativeRest<T>)
+            {
+                return index < args.size() ? args.subspan(index) : NativeArgs{};
+            }
+            else
+            {
+                const auto& arg = index < args.size() ? args[index] : std::shared_ptr<Object>{};
+                if constexpr (std::is_same_v<Bare,bool>)
+                {
+                    return nativeToBoolean(arg,ctx);
+                }
+                else if constexpr (std::is_integral_v<Bare>)
+                {
+                    return static_cast<Bare>(nativeToInteger(arg,ctx));
+                }
+                else if constexpr (std::is_floating_point_v<Bare>)
+                {
+                    return static_cast<Bare>(nativeToDouble(arg,ctx));
+                }
+                else if constexpr (std::is_same_v<Bare,std::string>)
+                {
+                    return nativeToString(arg,ctx);
+                }
+                else if constexpr (std::is_same_v<Bare,std::shared_ptr<Object>>)
+                {
+                    return std::shared_ptr<Object>(arg);
+                }
+                else
+                {
+                    static_assert(IsSharedPtr<Bare>::value,"Unsupported native argument type");
+                    auto result = cast<typename IsSharedPtr<Bare>::Element>(arg);
+                    if(!result)
+                    {
+                        throwNativeArgumentError(ctx,index);
+                    }
+
+                    return result;
+                }
+            }
+        }
+
+        template<typename R>
+        std::shared_ptr<Object> nativeReturn(R&& value)
+        {
+            using Bare = NativeBare<R>;
+            if constexpr (IsSharedPtr<Bare>::value)
+            {
+                return value ? std::shared_ptr<Object>(std::forward<R>(value)) : std::shared_ptr<Object>{};
+            }
+            else if constexpr (std::is_same_v<Bare,bool> || std::is_same_v<Bare,std::string>)
+            {
+                return nativeResult(value);
+            }
+            else if constexpr (std::is_integral_v<Bare>)
+            {
+                return nativeResult(static_cast<int64_t>(value));
+            }
+            else
+            {
+                static_assert(std::is_floating_point_v<Bare>,"Unsupported native return type");
+                return nativeResult(static_cast<double>(value));
+            }
+        }
+
+        template<typename R,typename TCall>
+        std::shared_ptr<Object> nativeInvoke(TCall&& call)
+        {
+            if constexpr (std::is_void_v<R>)
+            {
+                call();
+                return {};
+            }
+            else
+            {
+                return nativeReturn(call());
+            }
+        }
+
+        template<typename TFn>
+        struct NativeSignature;
+
+        template<typename R,typename ...TArgs>
+        struct NativeSignature<R(*)(TArgs...)>
+        {
+            template<auto Fn,size_t ...I>
+            static std::shared_ptr<Object> Invoke(NativeArgs args,NativeCallContext& ctx,std::index_sequence<I...>)
+            {
+                constexpr auto slots = nativeArgumentSlots<TArgs...>();
+                return nativeInvoke<R>([&]() -> decltype(auto)
+                {
+                    return Fn(nativeArgument<TArgs>(args,slots[I],ctx)...);
+                });
+            }
+        };
+
+        template<typename R,typename T,typename ...TArgs>
+        struct NativeMemberSignature
+        {
+            template<auto Fn,size_t ...I>
+            static std::shared_ptr<Object> Invoke(NativeArgs args,NativeCallContext& ctx,std::index_sequence<I...>)
+            {
+                constexpr auto slots = nativeArgumentSlots<TArgs...>();
+                const auto owner = ctx.GetSelf();
+                const auto self = dynamic_cast<T*>(owner.get());
+                if(!self)
+                {
+                    throw std::runtime_error("Native method called without an instance");
+                }
+
+                return nativeInvoke<R>([&]() -> decltype(auto)
+                {
+                    return (self->*Fn)(nativeArgument<TArgs>(args,slots[I],ctx)...);
+                });
+            }
+        };
+
+        template<typename R,typename T,typename ...TArgs>
+        struct NativeSignature<R(T::*)(TArgs...)> : NativeMemberSignature<R,T,TArgs...> {};
+
+        template<typename R,typename T,typename ...TArgs>
+        struct NativeSignature<R(T::*)(TArgs...) const> : NativeMemberSignature<R,T,TArgs...> {};
+
+        template<typename TFn>
+        struct NativeArity;
+
+        template<typename R,typename ...TArgs>
+        struct NativeArity<R(*)(TArgs...)> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<typename R,typename T,typename ...TArgs>
+        struct NativeArity<R(T::*)(TArgs...)> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<typename R,typename T,typename ...TArgs>
+        struct NativeArity<R(T::*)(TArgs...) const> : std::integral_constant<size_t,sizeof...(TArgs)> {};
+
+        template<auto Fn>
+        std::shared_ptr<Object> nativeThunk(NativeArgs args,NativeCallContext& ctx)
+        {
+            using Signature = NativeSignature<decltype(Fn)>;
+            return Signature::template Invoke<Fn>(args,ctx,std::make_index_sequence<NativeArity<decltype(Fn)>::value>{});
+        }
+    }
+
+    // Generates the argument conversion for a free function or member function at compile time, e.g.
+    // bindNative<&List::GetSize>(). Members are called on the object the method was accessed on. Parameters can be
+    // numbers, bool, std::string, std::shared_ptr to an object type, NativeCallContext& or a trailing NativeArgs for
+    // the remaining arguments. Returning void gives null
+    template<auto Fn>
+    constexpr NativeFunctionPointer bindNative()
+    {
+        return &detail::nativeThunk<Fn>;
+    }
+}
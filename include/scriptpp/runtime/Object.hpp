@@ -63,17 +63,13 @@ namespace spp::runtime
     
 
 
+    // Signals a return, the value itself is stored in the function scope's result slot
     class ReturnValue : public  Object
     {
-        std::shared_ptr<Object> _value;
     public:
-        ReturnValue(const std::shared_ptr<Object>& val);
-
         EObjectType GetType() const override;
 
         std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
-
-        std::shared_ptr<Object> GetValue() const;
     };
 
     class FlowControl : public Object
@@ -107,7 +103,7 @@ namespace spp::runtime
         return d;
     }
 
-    std::shared_ptr<ReturnValue> makeReturnValue(const std::shared_ptr<Object>& val);
+    std::shared_ptr<ReturnValue> makeReturnValue();
 
     std::shared_ptr<FlowControl> makeFlowControl(const FlowControl::EFlowControlOp& val);
 
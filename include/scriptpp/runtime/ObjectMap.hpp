@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Object.hpp"
+
+namespace spp::runtime
+{
+    // Open addressing hash table keyed by script objects. Entries sit in a dense vector in insertion order, the slot
+    // array only holds entry indices tagged with part of the hash so most probes never touch an entry
+    class ObjectMap
+    {
+    public:
+        struct Entry
+        {
+            size_t hash = 0;
+            std::shared_ptr<Object> key{};
+            std::shared_ptr<Object> value{};
+        };
+
+        // Walks live entries in insertion order
+        class ConstIterator
+        {
+            const Entry* _current;
+            const Entry* _end;
+
+            void SkipRemoved();
+        public:
+            ConstIterator(const Entry* current,const Entry* end);
+
+            const Entry& operator*() const;
+            const Entry* operator->() const;
+            ConstIterator& operator++();
+            bool operator==(const ConstIterator& other) const;
+        };
+
+        ObjectMap() = default;
+
+        size_t Size() const;
+
+        bool Empty() const;
+
+        void Reserve(size_t count);
+
+        void Clear();
+
+        // Returns the stored value or nullptr when the key is missing
+        std::shared_ptr<Object>* Find(const std::shared_ptr<Object>& key);
+        const std::shared_ptr<Object>* Find(const std::shared_ptr<Object>& key) const;
+
+        bool Contains(const std::shared_ptr<Object>& key) const;
+
+        // Inserts or assigns, an existing key keeps its position
+        void Set(const std::shared_ptr<Object>& key,const std::shared_ptr<Object>& value);
+
+        bool Erase(const std::shared_ptr<Object>& key);
+
+        ConstIterator begin() const;
+        ConstIterator end() const;
+
+        // Raw entry storage in insertion order, removed entries have no key. Positions only shift when the layout
+        // version changes
+        const std::vector<Entry>& GetEntries() const;
+
+        size_t GetLayoutVersion() const;
+
+        // While pinned, removed entries are kept in place instead of compacted so positions held by an iterator stay
+        // valid. Clear still moves everything and bumps the layout version
+        void Pin();
+        void Unpin();
+
+        // Strings and numbers are hashed and compared without virtual calls
+        static size_t Hash(const std::shared_ptr<Object>& key);
+
+        // What Hash returns for a number with this value, whatever its storage type
+        static size_t HashInteger(int64_t value);
+        static size_t HashFloating(double value);
+        static bool KeysEqual(const std::shared_ptr<Object>& a,const std::shared_ptr<Object>& b);
+
+    private:
+        static constexpr uint64_t EMPTY_SLOT = 0;
+        static constexpr uint64_t REMOVED_SLOT = 1;
+        static constexpr size_t MIN_CAPACITY = 8;
+
+        std::vector<Entry> _entries{};
+        std::vector<uint64_t> _slots{};
+        size_t _size = 0;
+        uint32_t _shift = 64;
+        size_t _layoutVersion = 0;
+        size_t _pins = 0;
+
+        // Position of the slot holding key, or the slot array size when missing
+        size_t FindSlot(const std::shared_ptr<Object>& key,size_t hash) const;
+
+        void Rehash(size_t capacity);
+    };
+}
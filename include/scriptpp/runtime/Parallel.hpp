@@ -0,0 +1,49 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Function.hpp"
+
+namespace spp::runtime
+{
+    // Persistent threads shared by the parallel List methods
+    class WorkerPool
+    {
+        struct Job;
+
+        std::vector<std::thread> _workers{};
+        std::deque<std::shared_ptr<Job>> _jobs{};
+        std::mutex _mutex{};
+        std::condition_variable _wake{};
+        std::condition_variable _done{};
+        bool _stopping = false;
+
+        explicit WorkerPool(size_t workers);
+
+        void WorkerLoop();
+
+        static void RunChunks(Job& job);
+    public:
+        static WorkerPool& Get();
+
+        ~WorkerPool();
+
+        // Number of threads taking part in a job, including the caller
+        size_t GetSize() const;
+
+        // Runs body over [0,count) in chunks of grain items. The caller works on the job too so nested calls can't deadlock.
+        // Blocks until every chunk is done and rethrows the first exception raised by body
+        void ParallelFor(size_t count,size_t grain,const std::function<void(size_t,size_t)>& body);
+    };
+
+    // Throws unless fn is a script function that can run on several threads at once, i.e. it doesn't assign to
+    // captured variables and only writes to objects it constructed itself. Parameters, captures and anything reached
+    // through them may only be read. Captured natives must be read-only methods or a known thread safe builtin
+    void ensureIsolated(const std::string& method,const std::shared_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& scope);
+}
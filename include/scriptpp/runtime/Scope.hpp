@@ -27,11 +27,19 @@ namespace spp::runtime
         ST_Program
     };
 
+    // One bit per EScopeType, a scope's mask holds its own type and the types of every scope around it
+    using ScopeTypeMask = uint32_t;
+
+    constexpr ScopeTypeMask scopeTypeBit(EScopeType type)
+    {
+        return ScopeTypeMask{1} << type;
+    }
+
     class ScopeLike
     {
     public:
 
-        virtual std::list<EScopeType> GetScopeStack() const = 0;
+        virtual ScopeTypeMask GetScopeMask() const = 0;
         virtual bool HasScopeType(EScopeType type) const = 0;
         virtual EScopeType GetScopeType() const = 0;
         
@@ -50,15 +58,23 @@ namespace spp::runtime
     {
         std::unordered_map<std::string,std::shared_ptr<Object>> _data;
         std::shared_ptr<ScopeLike> _outer;
-        std::list<EScopeType> _scopeStack;
+        EScopeType _scopeType = ST_None;
+        ScopeTypeMask _scopeMask = 0;
+
+    protected:
+        // Drops every variable and moves the scope under outer, used when a pooled frame is reused
+        void Rebind(const std::shared_ptr<ScopeLike>& outer);
+
+        // Drops every variable and the outer scope so a pooled frame keeps nothing alive
+        void Clear();
         
     public:
         Scope();
-        Scope(const std::shared_ptr<ScopeLike>& outer);
+        Scope(const std::shared_ptr<ScopeLike>& outer,EScopeType type = ST_None);
         std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
         EObjectType GetType() const override;
         
-        std::list<EScopeType> GetScopeStack() const override;
+        ScopeTypeMask GetScopeMask() const override;
         bool HasScopeType(EScopeType type) const override;
         EScopeType GetScopeType() const override;
 
@@ -87,7 +103,7 @@ namespace spp::runtime
         std::shared_ptr<ScopeLike> _scope;
     public:
         ScopeLikeProxyShared(const std::shared_ptr<ScopeLike>& scope);
-        std::list<EScopeType> GetScopeStack() const override;
+        ScopeTypeMask GetScopeMask() const override;
         bool HasScopeType(EScopeType type) const override;
         void Assign(const std::string& id, const std::shared_ptr<Object>& var) override;
         void Create(const std::string& id, const std::shared_ptr<Object>& var) override;
@@ -103,7 +119,7 @@ namespace spp::runtime
         std::weak_ptr<ScopeLike> _scope;
     public:
         ScopeLikeProxyWeak(const std::weak_ptr<ScopeLike>& scope);
-        std::list<EScopeType> GetScopeStack() const override;
+        ScopeTypeMask GetScopeMask() const override;
         bool HasScopeType(EScopeType type) const override;
         void Assign(const std::string& id, const std::shared_ptr<Object>& var) override;
         void Create(const std::string& id, const std::shared_ptr<Object>& var) override;
@@ -121,6 +137,11 @@ namespace spp::runtime
     public:
         CallScope(const std::optional<frontend::TokenDebugInfo>& calledAt,const std::shared_ptr<ScopeLike>& scope);
         std::string ToString() const;
+
+        void Reset(const std::optional<frontend::TokenDebugInfo>& calledAt,const std::shared_ptr<ScopeLike>& scope);
+
+        // Called by FramePool before the call scope is stored for reuse
+        void Release();
     };
 
     class Reference : public Object
@@ -133,6 +154,9 @@ namespace spp::runtime
         virtual std::shared_ptr<Object> Get() const;
         virtual void Set(const std::shared_ptr<Object>& val);
 
+        // The scope the referenced value lives in
+        std::shared_ptr<ScopeLike> GetScope() const;
+
         EObjectType GetType() const override;
         std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
         bool ToBoolean(const std::shared_ptr<ScopeLike>& scope) const override;
@@ -179,8 +203,11 @@ namespace spp::runtime
 
     std::shared_ptr<ScopeLikeProxyWeak> makeRefScopeProxy(const std::weak_ptr<ScopeLike>& scope);
 
+    // Reuses a call scope from this thread's pool when one is free, hand it back with releaseCallScope
     std::shared_ptr<CallScope> makeCallScope(const std::optional<frontend::TokenDebugInfo>& calledAt = {},const std::shared_ptr<ScopeLike>& scope = {});
 
+    void releaseCallScope(std::shared_ptr<CallScope>&& callScope);
+
     std::shared_ptr<Object> resolveReference(const std::shared_ptr<Object>& obj);
 
     std::shared_ptr<OneLayerScopeProxy> makeOneLayerScopeProxy(const std::shared_ptr<ScopeLike>& scope);
@@ -1,16 +1,58 @@
 #pragma once
+#include <atomic>
+#include <mutex>
+#include <string_view>
 #include "DynamicObject.hpp"
 #include "Object.hpp"
 
 namespace spp::runtime
 {
+    // Strings are immutable, which lets literals and identifier keys be interned and their hash cached.
+    // Concatenation produces a rope node that is only flattened into _str once the value is read.
+    // Slices share their parent's buffer and only copy it into _str when GetNative is called.
     class String : public DynamicObject
     {
-        std::string _str;
+        friend std::shared_ptr<String> makeStringSlice(const std::shared_ptr<String>& str, size_t offset, size_t size);
+        
+        mutable std::string _str;
+        // Rope children, released once the node is flat. Other threads flattening a rope this node is part of may
+        // still be reading them, hence the atomics
+        mutable std::atomic<std::shared_ptr<String>> _left{};
+        mutable std::atomic<std::shared_ptr<String>> _right{};
+        mutable std::atomic<bool> _flat = true;
+        mutable std::once_flag _flattenOnce{};
+        const std::shared_ptr<String> _parent{};
+        const size_t _offset = 0;
+        const size_t _size = 0;
+        const bool _interned = false;
+        mutable std::atomic<size_t> _hash = 0;
+
+        void Flatten() const;
+        void ReleaseChildren() const;
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<Function> BindNativeMethod(const std::string& id) const override;
     public:
-        void Init() override;
-        String(const std::string&str);
+        String(const std::string&str,bool interned = false);
+        String(std::string&&str);
+        String(const std::shared_ptr<String>& left,const std::shared_ptr<String>& right);
+        String(const std::shared_ptr<String>& parent,size_t offset,size_t size);
+        ~String() override;
+        
+        // Concatenations shorter than this are copied immediately instead of creating a rope node
+        static constexpr size_t ROPE_MIN_SIZE = 256;
+
+        // Slices shorter than this are copied, they fit in the small string buffer or close to it
+        static constexpr size_t VIEW_MIN_SIZE = 64;
+
+        // A slice is copied instead of viewed when the parent is more than this many times larger
+        static constexpr size_t VIEW_MAX_WASTE = 8;
+        
         EObjectType GetType() const override;
+        const std::string& GetNative() const;
+        std::string_view GetView() const;
+        size_t GetSize() const;
+        bool IsInterned() const;
         std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
         bool ToBoolean(const std::shared_ptr<ScopeLike>& scope) const override;
         bool Equal(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope) const override;
@@ -19,11 +61,36 @@ namespace spp::runtime
         std::shared_ptr<Object> Split(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> Size(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> Trim(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> IndexOf(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Contains(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Replace(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> StartsWith(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> EndsWith(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> ToUpper(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> ToLower(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Repeat(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Slice(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Iter(const std::shared_ptr<FunctionScope>& fnScope);
         std::shared_ptr<Object> Get(const std::shared_ptr<Object>& key, const std::shared_ptr<ScopeLike>& scope) const override;
         void Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& val, const std::shared_ptr<ScopeLike>& scope) override;
+        void Assign(const std::string& id, const std::shared_ptr<Object>& var) override;
+        void Create(const std::string& id, const std::shared_ptr<Object>& var) override;
         size_t GetHashCode(const std::shared_ptr<ScopeLike>& scope) override;
-        
+
+        static const NativeMethodTable<String>& GetMethods();
     };
 
     std::shared_ptr<String> makeString(const std::string& str);
+
+    std::shared_ptr<String> makeString(std::string&& str);
+
+    // Returns a string sharing the buffer of str where that is worthwhile, str is flattened if needed
+    std::shared_ptr<String> makeStringSlice(const std::shared_ptr<String>& str, size_t offset, size_t size);
+
+    // Returns the shared single character string for c
+    std::shared_ptr<String> makeCharString(char c);
+
+    // Returns the single shared instance for this value, used for literals and identifiers. The table only holds weak
+    // references, a value is dropped once nothing else uses it
+    std::shared_ptr<String> makeInternedString(const std::string& str);
 }
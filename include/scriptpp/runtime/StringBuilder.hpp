@@ -0,0 +1,50 @@
+#pragma once
+#include "DynamicObject.hpp"
+#include "Prototype.hpp"
+
+namespace spp::runtime
+{
+    class StringBuilderPrototype;
+
+    // Mutable buffer for building large strings without copying on every append
+    class StringBuilder : public DynamicObject
+    {
+        std::string _buffer;
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<Function> BindNativeMethod(const std::string& id) const override;
+    public:
+        StringBuilder();
+
+        std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
+        bool ToBoolean(const std::shared_ptr<ScopeLike>& scope) const override;
+
+        std::shared_ptr<Object> Append(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> AppendLine(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Build(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Size(const std::shared_ptr<FunctionScope>& fnScope);
+        std::shared_ptr<Object> Clear(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::string& GetNative();
+
+        size_t GetHashCode(const std::shared_ptr<ScopeLike>& scope) override;
+
+        static std::shared_ptr<StringBuilderPrototype> Prototype;
+
+        static const NativeMethodTable<StringBuilder>& GetMethods();
+    };
+
+    class StringBuilderPrototype : public Prototype
+    {
+    public:
+        StringBuilderPrototype();
+
+        std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
+
+        std::shared_ptr<DynamicObject> CreateInstance(std::shared_ptr<FunctionScope>& scope) override;
+
+        std::string GetName() const override;
+    };
+
+    std::shared_ptr<StringBuilder> makeStringBuilder();
+}
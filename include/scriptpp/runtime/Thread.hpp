@@ -1,40 +1,21 @@
 ﻿#pragma once
 #include <thread>
 
-#include "DynamicObject.hpp"
-#include "Prototype.hpp"
+#include "scriptpp/bind.hpp"
 
 namespace spp::runtime
 {
-
-    class ThreadPrototype;
-    
-    class Thread : public DynamicObject
+    // Exposed to scripts as Thread through bind::Class, every script object holds one inline
+    class Thread
     {
         std::thread _thread{};
-        
-    protected:
         std::pair<std::shared_ptr<Function>,std::shared_ptr<ScopeLike>> _fn{};
     public:
-        static std::shared_ptr<ThreadPrototype> Prototype;
-        explicit Thread(const std::shared_ptr<ScopeLike>& scope);
-        void Init() override;
-        static std::shared_ptr<DynamicObject> CreateInstance(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> Start(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> Join(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> IsActive(const std::shared_ptr<FunctionScope>& fnScope);
-        std::shared_ptr<Object> Constructor(const std::shared_ptr<FunctionScope>& fnScope);
-    };
-
-    std::shared_ptr<Thread> makeThread(const std::shared_ptr<ScopeLike>& scope);
-
-    class ThreadPrototype : public Prototype
-    {
-    public:
-        ThreadPrototype();
-
-        std::string GetName() const override;
+        Thread(const std::shared_ptr<Object>& callback,NativeCallContext& ctx);
+        void Start(NativeCallContext& ctx);
+        void Join(NativeCallContext& ctx);
+        bool IsActive() const;
 
-        std::shared_ptr<DynamicObject> CreateInstance(std::shared_ptr<FunctionScope>& scope) override;
+        static const bind::Class<Thread>& GetClass();
     };
 }
@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+
+#include "DynamicObject.hpp"
+#include "Prototype.hpp"
+
+namespace spp::runtime
+{
+    class TuplePrototype;
+
+    // Immutable sequence meant for composite keys. The hash is computed once from the items, equality only walks the
+    // items when the hashes match and interned tuples compare by identity. Items are frozen when the tuple is made, see
+    // Freeze
+    class Tuple : public DynamicObject
+    {
+        const std::vector<std::shared_ptr<Object>> _items;
+        const size_t _hash;
+        const bool _interned;
+    protected:
+        bool HasNativeMethod(const std::string& id) const override;
+        std::shared_ptr<Function> BindNativeMethod(const std::string& id) const override;
+    public:
+        Tuple(std::vector<std::shared_ptr<Object>>&& items,bool interned = false);
+
+        static std::shared_ptr<TuplePrototype> Prototype;
+
+        static const NativeMethodTable<Tuple>& GetMethods();
+
+        // True for values whose hash and equality can never change, these are kept in a tuple as they are
+        static bool IsImmutable(const std::shared_ptr<Object>& item);
+
+        // Makes items safe to keep in a tuple: lists become tuples of their items, recursively, and anything else whose
+        // hash could change later throws, e.g. dictionaries and class instances
+        static std::vector<std::shared_ptr<Object>> Freeze(std::vector<std::shared_ptr<Object>>&& items);
+
+        // Same hash the tuple caches, usable before the tuple exists
+        static size_t HashItems(const std::vector<std::shared_ptr<Object>>& items);
+
+        const std::vector<std::shared_ptr<Object>>& GetItems() const;
+
+        size_t GetSize() const;
+
+        bool IsInterned() const;
+
+        bool ItemsEqual(const std::vector<std::shared_ptr<Object>>& items) const;
+
+        std::shared_ptr<Object> Size(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> ToList(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Iter(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Intern(const std::shared_ptr<FunctionScope>& fnScope);
+
+        std::shared_ptr<Object> Get(const std::shared_ptr<Object>& key, const std::shared_ptr<ScopeLike>& scope) const override;
+        void Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& val, const std::shared_ptr<ScopeLike>& scope) override;
+        void Assign(const std::string& id, const std::shared_ptr<Object>& var) override;
+        void Create(const std::string& id, const std::shared_ptr<Object>& var) override;
+
+        bool Equal(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope) const override;
+        size_t GetHashCode(const std::shared_ptr<ScopeLike>& scope) override;
+        bool ToBoolean(const std::shared_ptr<ScopeLike>& scope) const override;
+        std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
+    };
+
+    std::shared_ptr<Tuple> makeTuple(std::vector<std::shared_ptr<Object>>&& items);
+
+    // Returns the single live instance holding these items, interned tuples are only kept alive by their users
+    std::shared_ptr<Tuple> makeInternedTuple(std::vector<std::shared_ptr<Object>>&& items);
+
+    class TuplePrototype : public Prototype
+    {
+    public:
+        TuplePrototype();
+
+        void Init() override;
+
+        std::string ToString(const std::shared_ptr<ScopeLike>& scope) const override;
+
+        std::shared_ptr<DynamicObject> CreateInstance(std::shared_ptr<FunctionScope>& scope) override;
+
+        std::string GetName() const override;
+
+        std::shared_ptr<Object> Intern(const std::shared_ptr<FunctionScope>& fnScope);
+    };
+}
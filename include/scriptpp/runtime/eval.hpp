@@ -31,16 +31,26 @@ namespace spp::runtime
                                          const std::shared_ptr<Function>& fn, const std::shared_ptr<ScopeLike>& scope);
     std::shared_ptr<Object> evalCall(const std::shared_ptr<frontend::CallNode>& ast,
                                      const std::shared_ptr<ScopeLike>& scope);
+    // Evaluates what is being called and throws when it is not callable
+    std::shared_ptr<Function> evalCallTarget(const std::shared_ptr<frontend::CallNode>& ast,
+                                             const std::shared_ptr<ScopeLike>& scope);
+    // Evaluates a call in return position and leaves it in fnScope instead of making it
+    void evalTailCall(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<FunctionScope>& fnScope,
+                      const std::shared_ptr<ScopeLike>& scope);
     std::shared_ptr<Object> evalFor(const std::shared_ptr<frontend::ForNode>& ast,
                                     const std::shared_ptr<ScopeLike>& scope);
+    std::shared_ptr<Object> evalForIn(const std::shared_ptr<frontend::ForInNode>& ast,
+                                    const std::shared_ptr<ScopeLike>& scope);
+
     std::shared_ptr<Object> evalWhile(const std::shared_ptr<frontend::WhileNode>& ast,
                                       const std::shared_ptr<ScopeLike>& scope);
     std::shared_ptr<Object> evalStatement(const std::shared_ptr<frontend::Node>& ast,
                                           const std::shared_ptr<ScopeLike>& scope);
     std::shared_ptr<Object> evalAccess(const std::shared_ptr<frontend::AccessNode>& ast,
                                        const std::shared_ptr<ScopeLike>& scope);
+    // keepReference returns a reference for list slots so the result can be assigned through
     std::shared_ptr<Object> evalIndex(const std::shared_ptr<frontend::IndexNode>& ast,
-                                        const std::shared_ptr<ScopeLike>& scope);
+                                        const std::shared_ptr<ScopeLike>& scope,bool keepReference = false);
     std::shared_ptr<Object> evalAssign(const std::shared_ptr<frontend::AssignNode>& ast,
                                        const std::shared_ptr<ScopeLike>& scope);
 
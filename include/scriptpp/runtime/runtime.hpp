@@ -4,11 +4,18 @@
 #include "DynamicObject.hpp"
 #include "eval.hpp"
 #include "Function.hpp"
+#include "Iterator.hpp"
 #include "List.hpp"
+#include "Memoize.hpp"
 #include "Module.hpp"
+#include "NativeCall.hpp"
 #include "Null.hpp"
+#include "Parallel.hpp"
 #include "Object.hpp"
+#include "ObjectMap.hpp"
 #include "Prototype.hpp"
 #include "Scope.hpp"
 #include "String.hpp"
+#include "StringBuilder.hpp"
+#include "Tuple.hpp"
 #include "Program.hpp"
\ No newline at end of file
@@ -2,4 +2,7 @@
 #include "frontend/frontend.hpp"
 #include "runtime/runtime.hpp"
 #include "api.hpp"
+#include "bind.hpp"
+#include "numeric.hpp"
+#include "strings.hpp"
 #include "utils.hpp"
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Byte oriented string kernels used by the runtime String methods.
+// Searches use AVX2 when the CPU running the code has it and SSE2 otherwise, case mapping uses SSE2. Targets without
+// either fall back to scalar code.
+namespace spp::strings
+{
+    constexpr auto npos = std::string_view::npos;
+
+    size_t find(std::string_view str, std::string_view needle, size_t start = 0);
+
+    bool contains(std::string_view str, std::string_view needle);
+
+    bool startsWith(std::string_view str, std::string_view prefix);
+
+    bool endsWith(std::string_view str, std::string_view suffix);
+
+    // Splits on every occurrence of delimiter, an empty delimiter splits into single characters.
+    // The views point into str.
+    void split(std::vector<std::string_view>& result, std::string_view str, std::string_view delimiter);
+
+    // Returns a view of str without leading and trailing whitespace
+    std::string_view trim(std::string_view str);
+
+    std::string replace(std::string_view str, std::string_view from, std::string_view to);
+
+    std::string repeat(std::string_view str, size_t times);
+
+    // ASCII only case mapping, other bytes are copied unchanged
+    std::string toUpper(std::string_view str);
+
+    std::string toLower(std::string_view str);
+}
@@ -2,68 +2,25 @@
 #include <vector>
 #include <string>
 
+#include "strings.hpp"
 #include "runtime/Object.hpp"
 
 namespace spp
 {
     inline void split(std::vector<std::string>& result,const std::string& str,const std::string& delimiter = " ")
     {
-        std::string remaining = str.substr();
-        if(delimiter.empty())
+        std::vector<std::string_view> parts;
+        strings::split(parts,str,delimiter);
+        result.reserve(result.size() + parts.size());
+        for(auto &part : parts)
         {
-            for(auto &r : remaining)
-            {
-                result.emplace_back(1,r);
-            }
-            remaining = "";
-        }
-        else
-        {
-            auto pos = remaining.find_first_of(delimiter);
-            while(pos != std::string::npos)
-            {
-                result.push_back(remaining.substr(0,pos));
-                remaining = remaining.substr(pos + delimiter.size());
-                pos = remaining.find_first_of(delimiter);
-            }
-        }
-
-        if(!remaining.empty())
-        {
-            result.push_back(remaining);
+            result.emplace_back(part);
         }
     }
 
     inline std::string trim(const std::string& str)
     {
-        auto copied = str;
-        constexpr auto toTrim = {' ','\n','\t','\r'};
-        size_t diff = 0;
-        do
-        {
-            const auto start = copied.size();
-            for(auto &c : toTrim)
-            {
-                copied.erase(copied.find_last_not_of(c)+1); //suffixing chars
-            }
-            
-            diff = copied.size() - start;
-        } while(diff != 0);
-
-        diff = 0;
-        do
-        {
-            const auto start = copied.size();
-            for(auto &c : toTrim)
-            {
-                copied.erase(0, copied.find_first_not_of(c)); //prefixing chars
-            }
-            
-            diff = copied.size() - start;
-        } while(diff != 0);
-                 
-               
-        return copied;
+        return std::string(strings::trim(str));
     }
 
     inline bool isNum(const char c)
@@ -125,7 +125,8 @@ namespace spp::frontend {
         {"catch",TokenType::Catch},
         {"throw",TokenType::Throw},
         {"->",TokenType::Arrow},
-        {":",TokenType::Colon}
+        {":",TokenType::Colon},
+        {"in",TokenType::In}
     };
 
     std::unordered_map<TokenType, std::string> Token::KeyWordMap = ([]
@@ -1,5 +1,6 @@
 #include "scriptpp/frontend/tokenizer.hpp"
 
+#include <cctype>
 #include <fstream>
 #include <ranges>
 #include "scriptpp/utils.hpp"
@@ -35,6 +36,11 @@ namespace spp::frontend
         return pending;
     }
 
+    bool isWordChar(const char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
     bool isSplitToken(const Token& token)
     {
         switch (token.type)
@@ -178,7 +184,8 @@ namespace spp::frontend
 
                 if(matches.contains(combinedStr))
                 {
-                    matchedSize = true;
+                    // Keywords only match whole words so identifiers like forEach or index stay intact
+                    matchedSize = !(isWordChar(combinedStr.back()) && rawTokens && isWordChar(rawTokens.Front().value.front()));
                     break;
                 }
             }
@@ -229,7 +236,7 @@ namespace spp::frontend
                         debugSpan += tok.debugInfo;
                         searchTokens.emplace_back(tok);
                         
-                        while(!rawTokens && isInteger(rawTokens.Front().value))
+                        while(rawTokens && isInteger(rawTokens.Front().value))
                         {
                             tok = rawTokens.RemoveFront();
                             combinedStr += tok.value;
@@ -1,4 +1,5 @@
 ﻿#include "scriptpp/frontend/parser.hpp"
+#include "scriptpp/frontend/resolver.hpp"
 #include <stdexcept>
 
 namespace spp::frontend
@@ -186,6 +187,11 @@ namespace spp::frontend
         params = inParams;
         body = inBody;
         type = NodeType::Function;
+        freeVariables = findFreeVariables(params,body);
+        if(body)
+        {
+            markEnclosingVariables(body->statements,params);
+        }
     }
 
     CallNode::CallNode(const TokenDebugInfo& inDebugInfo, const std::shared_ptr<Node>& inLeft,
@@ -208,6 +214,15 @@ namespace spp::frontend
         type = NodeType::For;
     }
 
+    ForInNode::ForInNode(const TokenDebugInfo& inDebugInfo, const std::string& inId,
+                         const std::shared_ptr<Node>& inIterable, const std::shared_ptr<ScopeNode>& inBody) : Node(inDebugInfo)
+    {
+        id = inId;
+        iterable = inIterable;
+        body = inBody;
+        type = NodeType::ForIn;
+    }
+
     WhileNode::WhileNode(const TokenDebugInfo& inDebugInfo, const std::shared_ptr<Node>& inCondition,
                          const std::shared_ptr<ScopeNode>& inBody) : Node(inDebugInfo)
     {
@@ -223,6 +238,10 @@ namespace spp::frontend
         parents = inParents;
         scope = inScope;
         type = NodeType::Class;
+        if(scope)
+        {
+            markEnclosingVariables(scope->statements);
+        }
     }
 
     ModuleNode::ModuleNode(const TokenDebugInfo& inDebugInfo, const std::vector<std::shared_ptr<Node>>& inStatements) : Node(inDebugInfo)
@@ -510,11 +529,23 @@ namespace spp::frontend
         return std::make_shared<ReturnNode>(token.debugInfo,parseExpression(tokens));
     }
 
-    std::shared_ptr<ForNode> parseFor(TokenList& tokens)
+    std::shared_ptr<Node> parseFor(TokenList& tokens)
     {
         auto token = tokens.RemoveFront();
+        tokens.ExpectFront(TokenType::OpenParen).RemoveFront();
         TokenList targetTokens{};
         getTokensTill(targetTokens,tokens,std::set{TokenType::CloseParen},1);
+
+        // for (let item in iterable)
+        if(targetTokens.Size() > 3 && targetTokens.Front().type == TokenType::Let && std::next(targetTokens.GetList().begin(),2)->type == TokenType::In)
+        {
+            targetTokens.RemoveFront();
+            auto id = targetTokens.RemoveFront().value;
+            targetTokens.RemoveFront();
+            auto iterable = parseExpression(targetTokens);
+            return std::make_shared<ForInNode>(token.debugInfo,id,iterable,parseScope(tokens));
+        }
+        
         auto initStatement = parseStatement(targetTokens);
         auto conditionStatement = parseStatement(targetTokens);
         auto updateStatement = parseExpression(targetTokens);
@@ -524,6 +555,7 @@ namespace spp::frontend
     std::shared_ptr<WhileNode> parseWhile(TokenList& tokens)
     {
         auto token = tokens.RemoveFront();
+        tokens.ExpectFront(TokenType::OpenParen).RemoveFront();
         TokenList targetTokens{};
         getTokensTill(targetTokens,tokens,std::set{TokenType::CloseParen},1);
         
@@ -684,7 +716,16 @@ namespace spp::frontend
 
         auto arrow = tokens.ExpectFront(TokenType::Arrow).RemoveFront();
         
-        return std::make_shared<FunctionNode>(token.debugInfo,identifier, args,std::make_shared<ScopeNode>(arrow.debugInfo,std::vector{parseExpression(tokens)}));
+        // `fn f(x) -> expr` is `fn f(x) { return expr; }` so a call in expr is a tail call, `fn f() -> throw x` stays a
+        // statement
+        auto expression = parseExpression(tokens);
+        if(expression->type != NodeType::Throw)
+        {
+            expression = std::make_shared<ReturnNode>(arrow.debugInfo,expression);
+        }
+
+        std::vector<std::shared_ptr<Node>> body{expression};
+        return std::make_shared<FunctionNode>(token.debugInfo,identifier, args,std::make_shared<ScopeNode>(arrow.debugInfo,body));
     }
 
     std::vector<std::shared_ptr<Node>> parseCallArguments(TokenList& tokens)
@@ -907,6 +948,8 @@ namespace spp::frontend
         {
             node->statements.push_back(parseStatement(tokens));
         }
+
+        markEnclosingVariables(node->statements,{},true);
         return node;
     }
 }
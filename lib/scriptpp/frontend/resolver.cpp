@@ -0,0 +1,412 @@
+#include "scriptpp/frontend/resolver.hpp"
+
+#include <algorithm>
+#include <set>
+
+#include "scriptpp/frontend/parser.hpp"
+
+namespace spp::frontend
+{
+    namespace
+    {
+        void collectNames(const std::shared_ptr<Node>& node,std::set<std::string>& names);
+
+        void collectNames(const std::vector<std::shared_ptr<Node>>& nodes,std::set<std::string>& names)
+        {
+            for (auto &node : nodes)
+            {
+                collectNames(node,names);
+            }
+        }
+
+        void collectNames(const std::shared_ptr<Node>& node,std::set<std::string>& names)
+        {
+            if(!node)
+            {
+                return;
+            }
+
+            switch (node->type)
+            {
+            case NodeType::Identifier:
+                names.insert(std::dynamic_pointer_cast<IdentifierNode>(node)->value);
+                break;
+            case NodeType::BinaryOp:
+                {
+                    const auto op = std::dynamic_pointer_cast<BinaryOpNode>(node);
+                    collectNames(op->left,names);
+                    collectNames(op->right,names);
+                }
+                break;
+            case NodeType::ListLiteral:
+                collectNames(std::dynamic_pointer_cast<ListLiteralNode>(node)->values,names);
+                break;
+            case NodeType::CreateAndAssign:
+                collectNames(std::dynamic_pointer_cast<CreateAndAssignNode>(node)->value,names);
+                break;
+            case NodeType::Assign:
+                {
+                    const auto assign = std::dynamic_pointer_cast<AssignNode>(node);
+                    collectNames(assign->left,names);
+                    collectNames(assign->value,names);
+                }
+                break;
+            case NodeType::Scope:
+                collectNames(std::dynamic_pointer_cast<ScopeNode>(node)->statements,names);
+                break;
+            case NodeType::Access:
+                {
+                    // The right side is looked up in the object unless it is something other than a member name
+                    const auto access = std::dynamic_pointer_cast<AccessNode>(node);
+                    collectNames(access->left,names);
+                    if(access->right && access->right->type != NodeType::Identifier)
+                    {
+                        collectNames(access->right,names);
+                    }
+                }
+                break;
+            case NodeType::Index:
+                {
+                    const auto index = std::dynamic_pointer_cast<IndexNode>(node);
+                    collectNames(index->left,names);
+                    collectNames(index->within,names);
+                }
+                break;
+            case NodeType::When:
+                for (auto &branch : std::dynamic_pointer_cast<WhenNode>(node)->branches)
+                {
+                    collectNames(branch.expression,names);
+                    collectNames(branch.statement,names);
+                }
+                break;
+            case NodeType::Return:
+                collectNames(std::dynamic_pointer_cast<ReturnNode>(node)->expression,names);
+                break;
+            case NodeType::Throw:
+                collectNames(std::dynamic_pointer_cast<ThrowNode>(node)->expression,names);
+                break;
+            case NodeType::TryCatch:
+                {
+                    const auto tryCatch = std::dynamic_pointer_cast<TryCatchNode>(node);
+                    collectNames(tryCatch->tryScope,names);
+                    collectNames(tryCatch->catchScope,names);
+                }
+                break;
+            case NodeType::FunctionParameter:
+                collectNames(std::dynamic_pointer_cast<ParameterNode>(node)->defaultValue,names);
+                break;
+            case NodeType::Function:
+                {
+                    // Nested functions were resolved when they were parsed
+                    const auto& nested = std::dynamic_pointer_cast<FunctionNode>(node)->freeVariables;
+                    names.insert(nested.begin(),nested.end());
+                }
+                break;
+            case NodeType::Call:
+                {
+                    const auto call = std::dynamic_pointer_cast<CallNode>(node);
+                    collectNames(call->left,names);
+                    collectNames(call->positionalArguments,names);
+                    for (auto &[id,arg] : call->namedArguments)
+                    {
+                        collectNames(arg,names);
+                    }
+                }
+                break;
+            case NodeType::For:
+                {
+                    const auto loop = std::dynamic_pointer_cast<ForNode>(node);
+                    collectNames(loop->init,names);
+                    collectNames(loop->condition,names);
+                    collectNames(loop->update,names);
+                    collectNames(loop->body,names);
+                }
+                break;
+            case NodeType::ForIn:
+                {
+                    const auto loop = std::dynamic_pointer_cast<ForInNode>(node);
+                    collectNames(loop->iterable,names);
+                    collectNames(loop->body,names);
+                }
+                break;
+            case NodeType::While:
+                {
+                    const auto loop = std::dynamic_pointer_cast<WhileNode>(node);
+                    collectNames(loop->condition,names);
+                    collectNames(loop->body,names);
+                }
+                break;
+            case NodeType::Class:
+                {
+                    const auto prototype = std::dynamic_pointer_cast<PrototypeNode>(node);
+                    names.insert(prototype->parents.begin(),prototype->parents.end());
+                    collectNames(prototype->scope,names);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    namespace
+    {
+        void collectDeclarations(const std::shared_ptr<Node>& node,std::set<std::string>& names);
+
+        void collectDeclarations(const std::vector<std::shared_ptr<Node>>& nodes,std::set<std::string>& names)
+        {
+            for (auto &node : nodes)
+            {
+                collectDeclarations(node,names);
+            }
+        }
+
+        // Names declared in the scope node runs in and the blocks inside it. Functions and classes declare their own
+        // names here but their bodies are scopes of their own
+        void collectDeclarations(const std::shared_ptr<Node>& node,std::set<std::string>& names)
+        {
+            if(!node)
+            {
+                return;
+            }
+
+            switch (node->type)
+            {
+            case NodeType::CreateAndAssign:
+                {
+                    const auto& identifiers = std::dynamic_pointer_cast<CreateAndAssignNode>(node)->identifiers;
+                    names.insert(identifiers.begin(),identifiers.end());
+                }
+                break;
+            case NodeType::Function:
+                if(const auto& name = std::dynamic_pointer_cast<FunctionNode>(node)->name; !name.empty())
+                {
+                    names.insert(name);
+                }
+                break;
+            case NodeType::Class:
+                names.insert(std::dynamic_pointer_cast<PrototypeNode>(node)->id);
+                break;
+            case NodeType::Scope:
+                collectDeclarations(std::dynamic_pointer_cast<ScopeNode>(node)->statements,names);
+                break;
+            case NodeType::When:
+                for (auto &branch : std::dynamic_pointer_cast<WhenNode>(node)->branches)
+                {
+                    collectDeclarations(branch.statement,names);
+                }
+                break;
+            case NodeType::TryCatch:
+                {
+                    const auto tryCatch = std::dynamic_pointer_cast<TryCatchNode>(node);
+                    names.insert(tryCatch->catchArgumentName);
+                    collectDeclarations(tryCatch->tryScope,names);
+                    collectDeclarations(tryCatch->catchScope,names);
+                }
+                break;
+            case NodeType::For:
+                {
+                    const auto loop = std::dynamic_pointer_cast<ForNode>(node);
+                    collectDeclarations(loop->init,names);
+                    collectDeclarations(loop->body,names);
+                }
+                break;
+            case NodeType::ForIn:
+                {
+                    const auto loop = std::dynamic_pointer_cast<ForInNode>(node);
+                    names.insert(loop->id);
+                    collectDeclarations(loop->body,names);
+                }
+                break;
+            case NodeType::While:
+                collectDeclarations(std::dynamic_pointer_cast<WhileNode>(node)->body,names);
+                break;
+            default:
+                break;
+            }
+        }
+
+        void markFunctions(const std::shared_ptr<Node>& node,const std::set<std::string>& declared);
+
+        void markFunctions(const std::vector<std::shared_ptr<Node>>& nodes,const std::set<std::string>& declared)
+        {
+            for (auto &node : nodes)
+            {
+                markFunctions(node,declared);
+            }
+        }
+
+        void markFunctions(const std::shared_ptr<Node>& node,const std::set<std::string>& declared)
+        {
+            if(!node)
+            {
+                return;
+            }
+
+            switch (node->type)
+            {
+            case NodeType::Function:
+                {
+                    const auto fn = std::dynamic_pointer_cast<FunctionNode>(node);
+                    auto& marked = fn->enclosingVariables;
+                    for (auto &id : fn->freeVariables)
+                    {
+                        if(declared.contains(id))
+                        {
+                            marked.push_back(id);
+                        }
+                    }
+                    std::ranges::sort(marked);
+                    marked.erase(std::ranges::unique(marked).begin(),marked.end());
+
+                    for (auto &param : fn->params)
+                    {
+                        markFunctions(param->defaultValue,declared);
+                    }
+                    markFunctions(fn->body,declared);
+                }
+                break;
+            case NodeType::BinaryOp:
+                {
+                    const auto op = std::dynamic_pointer_cast<BinaryOpNode>(node);
+                    markFunctions(op->left,declared);
+                    markFunctions(op->right,declared);
+                }
+                break;
+            case NodeType::ListLiteral:
+                markFunctions(std::dynamic_pointer_cast<ListLiteralNode>(node)->values,declared);
+                break;
+            case NodeType::CreateAndAssign:
+                markFunctions(std::dynamic_pointer_cast<CreateAndAssignNode>(node)->value,declared);
+                break;
+            case NodeType::Assign:
+                {
+                    const auto assign = std::dynamic_pointer_cast<AssignNode>(node);
+                    markFunctions(assign->left,declared);
+                    markFunctions(assign->value,declared);
+                }
+                break;
+            case NodeType::Scope:
+                markFunctions(std::dynamic_pointer_cast<ScopeNode>(node)->statements,declared);
+                break;
+            case NodeType::Access:
+                {
+                    const auto access = std::dynamic_pointer_cast<AccessNode>(node);
+                    markFunctions(access->left,declared);
+                    markFunctions(access->right,declared);
+                }
+                break;
+            case NodeType::Index:
+                {
+                    const auto index = std::dynamic_pointer_cast<IndexNode>(node);
+                    markFunctions(index->left,declared);
+                    markFunctions(index->within,declared);
+                }
+                break;
+            case NodeType::When:
+                for (auto &branch : std::dynamic_pointer_cast<WhenNode>(node)->branches)
+                {
+                    markFunctions(branch.expression,declared);
+                    markFunctions(branch.statement,declared);
+                }
+                break;
+            case NodeType::Return:
+                markFunctions(std::dynamic_pointer_cast<ReturnNode>(node)->expression,declared);
+                break;
+            case NodeType::Throw:
+                markFunctions(std::dynamic_pointer_cast<ThrowNode>(node)->expression,declared);
+                break;
+            case NodeType::TryCatch:
+                {
+                    const auto tryCatch = std::dynamic_pointer_cast<TryCatchNode>(node);
+                    markFunctions(tryCatch->tryScope,declared);
+                    markFunctions(tryCatch->catchScope,declared);
+                }
+                break;
+            case NodeType::Call:
+                {
+                    const auto call = std::dynamic_pointer_cast<CallNode>(node);
+                    markFunctions(call->left,declared);
+                    markFunctions(call->positionalArguments,declared);
+                    for (auto &[id,arg] : call->namedArguments)
+                    {
+                        markFunctions(arg,declared);
+                    }
+                }
+                break;
+            case NodeType::For:
+                {
+                    const auto loop = std::dynamic_pointer_cast<ForNode>(node);
+                    markFunctions(loop->init,declared);
+                    markFunctions(loop->condition,declared);
+                    markFunctions(loop->update,declared);
+                    markFunctions(loop->body,declared);
+                }
+                break;
+            case NodeType::ForIn:
+                {
+                    const auto loop = std::dynamic_pointer_cast<ForInNode>(node);
+                    markFunctions(loop->iterable,declared);
+                    markFunctions(loop->body,declared);
+                }
+                break;
+            case NodeType::While:
+                {
+                    const auto loop = std::dynamic_pointer_cast<WhileNode>(node);
+                    markFunctions(loop->condition,declared);
+                    markFunctions(loop->body,declared);
+                }
+                break;
+            case NodeType::Class:
+                markFunctions(std::dynamic_pointer_cast<PrototypeNode>(node)->scope,declared);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    std::vector<std::string> findFreeVariables(const std::vector<std::shared_ptr<ParameterNode>>& params,
+        const std::shared_ptr<ScopeNode>& body)
+    {
+        std::set<std::string> names{};
+        collectNames(body,names);
+        for (auto &param : params)
+        {
+            collectNames(param,names);
+        }
+
+        for (auto &param : params)
+        {
+            names.erase(param->name);
+        }
+
+        return {names.begin(),names.end()};
+    }
+
+    void markEnclosingVariables(const std::vector<std::shared_ptr<Node>>& nodes,
+        const std::vector<std::shared_ptr<ParameterNode>>& params, bool topLevel)
+    {
+        std::set<std::string> declared{};
+        for (auto &param : params)
+        {
+            declared.insert(param->name);
+        }
+
+        for (auto &node : nodes)
+        {
+            // The module's own declarations land in the module scope, which closures always keep
+            if(topLevel && (node->type == NodeType::CreateAndAssign || node->type == NodeType::Function || node->type == NodeType::Class))
+            {
+                continue;
+            }
+
+            collectDeclarations(node,declared);
+        }
+
+        if(!declared.empty())
+        {
+            markFunctions(nodes,declared);
+        }
+    }
+}
@@ -0,0 +1,407 @@
+#include "scriptpp/numeric.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Like the string search, the AVX2 loops are compiled on every x86-64 build and picked at runtime
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SPP_NUMERIC_AVX2
+#define SPP_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_M_X64)
+#include <immintrin.h>
+#define SPP_NUMERIC_AVX2
+#define SPP_TARGET_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPP_NUMERIC_SSE2
+#endif
+
+namespace spp::numeric
+{
+    namespace
+    {
+        // Integer kernels check for overflow once per block of this many items rather than once per item
+        constexpr size_t BLOCK_SIZE = 256;
+
+        // Items of a block below these magnitudes can't overflow the block result, BLOCK_SIZE * 2^54 is 2^62
+        constexpr uint64_t SUM_LIMIT = uint64_t(1) << 54;
+        constexpr uint64_t DOT_LIMIT = uint64_t(1) << 27;
+        constexpr uint64_t ADD_LIMIT = uint64_t(1) << 62;
+
+        // Independent accumulators let the compiler keep several lanes busy
+        template<typename T, typename Op>
+        T reduce(std::span<const T> items, T initial, Op op)
+        {
+            T acc[4] = {initial,initial,initial,initial};
+            size_t i = 0;
+            for(; i + 4 <= items.size(); i += 4)
+            {
+                acc[0] = op(acc[0],items[i]);
+                acc[1] = op(acc[1],items[i + 1]);
+                acc[2] = op(acc[2],items[i + 2]);
+                acc[3] = op(acc[3],items[i + 3]);
+            }
+
+            for(; i < items.size(); i++)
+            {
+                acc[0] = op(acc[0],items[i]);
+            }
+
+            return op(op(acc[0],acc[1]),op(acc[2],acc[3]));
+        }
+
+        // True when every item is in [-limit,limit), limit being a power of two. Adding limit maps that range onto
+        // [0,2 * limit), so a single test of the or-ed values covers the block and the loop has no compares to vectorize
+        bool inRange(std::span<const int64_t> items, uint64_t limit)
+        {
+            uint64_t bits = 0;
+            for(const auto item : items)
+            {
+                bits |= static_cast<uint64_t>(item) + limit;
+            }
+
+            return bits < 2 * limit;
+        }
+
+        // Both return true when the exact result doesn't fit, out is only meaningful otherwise
+        bool addOverflows(int64_t a, int64_t b, int64_t& out)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_add_overflow(a,b,&out);
+#else
+            if((b > 0 && a > std::numeric_limits<int64_t>::max() - b) || (b < 0 && a < std::numeric_limits<int64_t>::min() - b))
+            {
+                return true;
+            }
+
+            out = a + b;
+            return false;
+#endif
+        }
+
+        bool mulOverflows(int64_t a, int64_t b, int64_t& out)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_mul_overflow(a,b,&out);
+#else
+            constexpr auto max = std::numeric_limits<int64_t>::max();
+            constexpr auto min = std::numeric_limits<int64_t>::min();
+            if(a > 0 ? (b > 0 ? a > max / b : b < min / a) : (b > 0 ? a < min / b : a != 0 && b < max / a))
+            {
+                return true;
+            }
+
+            out = a * b;
+            return false;
+#endif
+        }
+
+        double sumScalar(std::span<const double> items)
+        {
+            return reduce<double>(items,0,[](double a,double b){ return a + b; });
+        }
+
+        double dotScalar(std::span<const double> a, std::span<const double> b)
+        {
+            double result = 0;
+            for(size_t i = 0; i < a.size(); i++)
+            {
+                result += a[i] * b[i];
+            }
+
+            return result;
+        }
+
+#ifdef SPP_NUMERIC_SSE2
+        double sumSse2(std::span<const double> items)
+        {
+            auto acc0 = _mm_setzero_pd();
+            auto acc1 = _mm_setzero_pd();
+            size_t i = 0;
+            for(; i + 4 <= items.size(); i += 4)
+            {
+                acc0 = _mm_add_pd(acc0,_mm_loadu_pd(items.data() + i));
+                acc1 = _mm_add_pd(acc1,_mm_loadu_pd(items.data() + i + 2));
+            }
+
+            alignas(16) double lanes[2];
+            _mm_store_pd(lanes,_mm_add_pd(acc0,acc1));
+            return lanes[0] + lanes[1] + sumScalar(items.subspan(i));
+        }
+
+        double dotSse2(std::span<const double> a, std::span<const double> b)
+        {
+            auto acc0 = _mm_setzero_pd();
+            auto acc1 = _mm_setzero_pd();
+            size_t i = 0;
+            for(; i + 4 <= a.size(); i += 4)
+            {
+                acc0 = _mm_add_pd(acc0,_mm_mul_pd(_mm_loadu_pd(a.data() + i),_mm_loadu_pd(b.data() + i)));
+                acc1 = _mm_add_pd(acc1,_mm_mul_pd(_mm_loadu_pd(a.data() + i + 2),_mm_loadu_pd(b.data() + i + 2)));
+            }
+
+            alignas(16) double lanes[2];
+            _mm_store_pd(lanes,_mm_add_pd(acc0,acc1));
+            return lanes[0] + lanes[1] + dotScalar(a.subspan(i),b.subspan(i));
+        }
+#endif
+
+#ifdef SPP_NUMERIC_AVX2
+        bool hasAvx2()
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            // Needs both the CPU feature and OS support for saving the ymm registers
+            int info[4];
+            __cpuid(info,1);
+            if((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+            {
+                return false;
+            }
+
+            __cpuidex(info,7,0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        SPP_TARGET_AVX2 double sumAvx2(std::span<const double> items)
+        {
+            auto acc0 = _mm256_setzero_pd();
+            auto acc1 = _mm256_setzero_pd();
+            size_t i = 0;
+            for(; i + 8 <= items.size(); i += 8)
+            {
+                acc0 = _mm256_add_pd(acc0,_mm256_loadu_pd(items.data() + i));
+                acc1 = _mm256_add_pd(acc1,_mm256_loadu_pd(items.data() + i + 4));
+            }
+
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes,_mm256_add_pd(acc0,acc1));
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sumScalar(items.subspan(i));
+        }
+
+        SPP_TARGET_AVX2 double dotAvx2(std::span<const double> a, std::span<const double> b)
+        {
+            auto acc0 = _mm256_setzero_pd();
+            auto acc1 = _mm256_setzero_pd();
+            size_t i = 0;
+            for(; i + 8 <= a.size(); i += 8)
+            {
+                acc0 = _mm256_add_pd(acc0,_mm256_mul_pd(_mm256_loadu_pd(a.data() + i),_mm256_loadu_pd(b.data() + i)));
+                acc1 = _mm256_add_pd(acc1,_mm256_mul_pd(_mm256_loadu_pd(a.data() + i + 4),_mm256_loadu_pd(b.data() + i + 4)));
+            }
+
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes,_mm256_add_pd(acc0,acc1));
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a.subspan(i),b.subspan(i));
+        }
+
+        bool useAvx2()
+        {
+            static const auto supported = hasAvx2();
+            return supported;
+        }
+#endif
+    }
+
+    bool sum(std::span<const int64_t> items, int64_t& result)
+    {
+        result = 0;
+        for(size_t start = 0; start < items.size(); start += BLOCK_SIZE)
+        {
+            const auto block = items.subspan(start,std::min(BLOCK_SIZE,items.size() - start));
+            if(inRange(block,SUM_LIMIT))
+            {
+                if(addOverflows(result,reduce<int64_t>(block,0,[](int64_t a,int64_t b){ return a + b; }),result))
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            for(const auto item : block)
+            {
+                if(addOverflows(result,item,result))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    double sum(std::span<const double> items)
+    {
+#if defined(SPP_NUMERIC_AVX2)
+        if(useAvx2())
+        {
+            return sumAvx2(items);
+        }
+#endif
+#if defined(SPP_NUMERIC_SSE2)
+        return sumSse2(items);
+#else
+        return sumScalar(items);
+#endif
+    }
+
+    int64_t min(std::span<const int64_t> items)
+    {
+        return reduce<int64_t>(items,items.front(),[](int64_t a,int64_t b){ return std::min(a,b); });
+    }
+
+    double min(std::span<const double> items)
+    {
+        return reduce<double>(items,items.front(),[](double a,double b){ return std::min(a,b); });
+    }
+
+    int64_t max(std::span<const int64_t> items)
+    {
+        return reduce<int64_t>(items,items.front(),[](int64_t a,int64_t b){ return std::max(a,b); });
+    }
+
+    double max(std::span<const double> items)
+    {
+        return reduce<double>(items,items.front(),[](double a,double b){ return std::max(a,b); });
+    }
+
+    bool dot(std::span<const int64_t> a, std::span<const int64_t> b, int64_t& result)
+    {
+        result = 0;
+        for(size_t start = 0; start < a.size(); start += BLOCK_SIZE)
+        {
+            const auto size = std::min(BLOCK_SIZE,a.size() - start);
+            const auto blockA = a.subspan(start,size);
+            const auto blockB = b.subspan(start,size);
+            if(inRange(blockA,DOT_LIMIT) && inRange(blockB,DOT_LIMIT))
+            {
+                int64_t products = 0;
+                for(size_t i = 0; i < size; i++)
+                {
+                    products += blockA[i] * blockB[i];
+                }
+
+                if(addOverflows(result,products,result))
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            for(size_t i = 0; i < size; i++)
+            {
+                int64_t product;
+                if(mulOverflows(blockA[i],blockB[i],product) || addOverflows(result,product,result))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    double dot(std::span<const double> a, std::span<const double> b)
+    {
+#if defined(SPP_NUMERIC_AVX2)
+        if(useAvx2())
+        {
+            return dotAvx2(a,b);
+        }
+#endif
+#if defined(SPP_NUMERIC_SSE2)
+        return dotSse2(a,b);
+#else
+        return dotScalar(a,b);
+#endif
+    }
+
+    bool scale(std::span<const int64_t> items, int64_t factor, std::span<int64_t> out)
+    {
+        // |item| <= 2^k and |factor| < 2^bits keep the product below 2^63 when k + bits <= 63
+        const auto magnitude = factor < 0 ? uint64_t(0) - static_cast<uint64_t>(factor) : static_cast<uint64_t>(factor);
+        const auto bits = static_cast<int>(std::bit_width(magnitude));
+        const auto limit = bits >= 63 ? 0 : uint64_t(1) << std::min(62,63 - bits);
+        for(size_t start = 0; start < items.size(); start += BLOCK_SIZE)
+        {
+            const auto size = std::min(BLOCK_SIZE,items.size() - start);
+            const auto block = items.subspan(start,size);
+            if(limit != 0 && inRange(block,limit))
+            {
+                for(size_t i = 0; i < size; i++)
+                {
+                    out[start + i] = block[i] * factor;
+                }
+
+                continue;
+            }
+
+            for(size_t i = 0; i < size; i++)
+            {
+                if(mulOverflows(block[i],factor,out[start + i]))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void scale(std::span<const double> items, double factor, std::span<double> out)
+    {
+        for(size_t i = 0; i < items.size(); i++)
+        {
+            out[i] = items[i] * factor;
+        }
+    }
+
+    bool add(std::span<const int64_t> a, std::span<const int64_t> b, std::span<int64_t> out)
+    {
+        for(size_t start = 0; start < a.size(); start += BLOCK_SIZE)
+        {
+            const auto size = std::min(BLOCK_SIZE,a.size() - start);
+            const auto blockA = a.subspan(start,size);
+            const auto blockB = b.subspan(start,size);
+            if(inRange(blockA,ADD_LIMIT) && inRange(blockB,ADD_LIMIT))
+            {
+                for(size_t i = 0; i < size; i++)
+                {
+                    out[start + i] = blockA[i] + blockB[i];
+                }
+
+                continue;
+            }
+
+            for(size_t i = 0; i < size; i++)
+            {
+                if(addOverflows(blockA[i],blockB[i],out[start + i]))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void add(std::span<const double> a, std::span<const double> b, std::span<double> out)
+    {
+        for(size_t i = 0; i < a.size(); i++)
+        {
+            out[i] = a[i] + b[i];
+        }
+    }
+}
@@ -1,45 +1,137 @@
 ﻿#include "scriptpp/runtime/Dictionary.hpp"
 
 #include "scriptpp/runtime/Boolean.hpp"
+#include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Iterator.hpp"
+#include "scriptpp/runtime/List.hpp"
 #include "scriptpp/runtime/Null.hpp"
+#include "scriptpp/runtime/Number.hpp"
 #include "scriptpp/runtime/String.hpp"
 
 namespace spp::runtime
 {
-    Dictionary::Dictionary() : DynamicObject(makeScope())
+    namespace
     {
+        // Walks the live entry storage by position, entries added while iterating are visited as well. The map is
+        // pinned so removing entries doesn't move the rest, clearing it ends the iteration with an error
+        class DictionaryIterator : public Iterator
+        {
+            std::shared_ptr<Dictionary> _dict;
+            EDictionaryView _view;
+            size_t _index = 0;
+            size_t _layoutVersion;
+        public:
+            DictionaryIterator(const std::shared_ptr<Dictionary>& dict,EDictionaryView view) : _dict(dict), _view(view), _layoutVersion(dict->GetNative().GetLayoutVersion())
+            {
+                _dict->GetNative().Pin();
+            }
+
+            ~DictionaryIterator() override
+            {
+                _dict->GetNative().Unpin();
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                if (_dict->GetNative().GetLayoutVersion() != _layoutVersion)
+                {
+                    throw makeException(scope,"Dictionary was cleared during iteration");
+                }
+
+                const auto& entries = _dict->GetNative().GetEntries();
+                while (_index < entries.size() && !entries[_index].key)
+                {
+                    _index++;
+                }
+
+                if (_index >= entries.size())
+                {
+                    return false;
+                }
+
+                const auto& entry = entries[_index++];
+                switch (_view)
+                {
+                case EDictionaryView::Keys:
+                    value = entry.key;
+                    break;
+                case EDictionaryView::Values:
+                    value = entry.value;
+                    break;
+                case EDictionaryView::Items:
+                    value = makeList(vectorOf<std::shared_ptr<Object>>(entry.key,entry.value));
+                    break;
+                }
+
+                return true;
+            }
+        };
+
+        std::shared_ptr<List> asPair(const std::shared_ptr<Object>& item)
+        {
+            const auto pair = cast<List>(resolveReference(item));
+            return pair && pair->GetSize() == 2 ? pair : nullptr;
+        }
     }
 
-    Dictionary::Dictionary(const std::unordered_map<std::shared_ptr<Object>, std::shared_ptr<Object>>& data) : DynamicObject(makeScope())
+    bool Dictionary::HasNativeMethod(const std::string& id) const
     {
-        _entries = data;
+        return GetMethods().Has(id);
+    }
+
+    std::shared_ptr<Function> Dictionary::BindNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Bind(id,this);
+    }
+
+    Dictionary::Dictionary() : DynamicObject({})
+    {
+    }
+
+    Dictionary::Dictionary(const std::unordered_map<std::shared_ptr<Object>, std::shared_ptr<Object>>& data) : DynamicObject({})
+    {
+        _entries.Reserve(data.size());
+        for (auto &[key,val] : data)
+        {
+            _entries.Set(key,val);
+        }
     }
 
     std::shared_ptr<DictionaryPrototype> Dictionary::Prototype = makeObject<DictionaryPrototype>();
 
-    void Dictionary::Init()
+    const NativeMethodTable<Dictionary>& Dictionary::GetMethods()
     {
-        DynamicObject::Init();
-        AddNativeMemberFunction("put",this,vectorOf<std::string>("key","item"),&Dictionary::PutItem);
-        AddNativeMemberFunction("get",this,vectorOf<std::string>("key"),&Dictionary::GetItem);
-        AddNativeMemberFunction("has",this,vectorOf<std::string>("key"),&Dictionary::HasItem);
+        static const auto methods = NativeMethodTable<Dictionary>()
+            .Add("put",vectorOf<std::string>("key","item"),&Dictionary::PutItem)
+            .Add("get",vectorOf<std::string>("key"),&Dictionary::GetItem)
+            .Add("has",vectorOf<std::string>("key"),&Dictionary::HasItem)
+            .Add("remove",vectorOf<std::string>("key"),&Dictionary::RemoveItem)
+            .Add("size",vectorOf<std::string>(),&Dictionary::Size)
+            .Add("clear",vectorOf<std::string>(),&Dictionary::Clear)
+            .Add("update",vectorOf<std::string>("other"),&Dictionary::Update)
+            .Add("reserve",vectorOf<std::string>("count"),&Dictionary::Reserve)
+            .Add("keys",vectorOf<std::string>(),&Dictionary::Keys)
+            .Add("values",vectorOf<std::string>(),&Dictionary::Values)
+            .Add("items",vectorOf<std::string>(),&Dictionary::Items);
+        
+        return methods;
     }
 
     std::shared_ptr<Object> Dictionary::PutItem(const std::shared_ptr<FunctionScope>& fnScope)
     {
-        const auto key = fnScope->GetArgument(0);
-        auto val = fnScope->GetArgument(1);
-        _entries.insert_or_assign(key,val);
+        const auto key = resolveReference(fnScope->GetArgument(0));
+        auto val = resolveReference(fnScope->GetArgument(1));
+        _entries.Set(key,val);
         return this->GetRef();
     }
 
     std::shared_ptr<Object> Dictionary::GetItem(const std::shared_ptr<FunctionScope>& fnScope)
     {
-        auto key = fnScope->GetArgument(0);
+        auto key = resolveReference(fnScope->GetArgument(0));
         
-        if(_entries.contains(key))
+        if(const auto found = _entries.Find(key))
         {
-            return _entries.at(key);
+            return *found;
         }
 
         return makeNull();
@@ -47,32 +139,149 @@ namespace spp::runtime
 
     std::shared_ptr<Object> Dictionary::HasItem(const std::shared_ptr<FunctionScope>& fnScope)
     {
-        auto key = fnScope->GetArgument(0);
-        return makeBoolean(_entries.contains(key));
+        auto key = resolveReference(fnScope->GetArgument(0));
+        return makeBoolean(_entries.Contains(key));
+    }
+
+    std::shared_ptr<Object> Dictionary::RemoveItem(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto key = resolveReference(fnScope->GetArgument(0));
+        const auto found = _entries.Find(key);
+        if(!found)
+        {
+            return makeNull();
+        }
+
+        // Returns the removed value
+        const auto val = *found;
+        _entries.Erase(key);
+        return val;
+    }
+
+    std::shared_ptr<Object> Dictionary::Size(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeNumber(static_cast<int64_t>(_entries.Size()));
+    }
+
+    std::shared_ptr<Object> Dictionary::Clear(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        _entries.Clear();
+        return this->GetRef();
+    }
+
+    std::shared_ptr<Object> Dictionary::Update(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        Merge(resolveReference(fnScope->GetArgument(0)),fnScope);
+        return this->GetRef();
+    }
+
+    std::shared_ptr<Object> Dictionary::Reserve(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto arg = resolveReference(fnScope->GetArgument(0));
+        if(arg->GetType() != EObjectType::Number)
+        {
+            throw makeException(fnScope,"reserve expects a number");
+        }
+
+        if(const auto count = castStatic<Number>(arg)->GetValueAs<int64_t>(); count > 0)
+        {
+            _entries.Reserve(static_cast<size_t>(count));
+        }
+
+        return this->GetRef();
+    }
+
+    std::shared_ptr<Object> Dictionary::Keys(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<DictionaryView>(castStatic<Dictionary>(this->GetRef()),EDictionaryView::Keys);
+    }
+
+    std::shared_ptr<Object> Dictionary::Values(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<DictionaryView>(castStatic<Dictionary>(this->GetRef()),EDictionaryView::Values);
+    }
+
+    std::shared_ptr<Object> Dictionary::Items(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<DictionaryView>(castStatic<Dictionary>(this->GetRef()),EDictionaryView::Items);
+    }
+
+    void Dictionary::Merge(const std::shared_ptr<Object>& source, const std::shared_ptr<ScopeLike>& scope)
+    {
+        if(const auto other = cast<Dictionary>(source))
+        {
+            if(other.get() == this)
+            {
+                return;
+            }
+
+            _entries.Reserve(_entries.Size() + other->_entries.Size());
+            for(auto &entry : other->_entries)
+            {
+                _entries.Set(entry.key,entry.value);
+            }
+
+            return;
+        }
+
+        if(const auto list = cast<List>(source))
+        {
+            // Validate first so a bad pair leaves the dictionary untouched
+            const auto count = list->GetSize();
+            for(size_t i = 0; i < count; i++)
+            {
+                if(!asPair(list->GetItem(i)))
+                {
+                    throw makeException(scope,"Expected [key , value] pairs but got " + list->GetItem(i)->ToString(scope));
+                }
+            }
+
+            _entries.Reserve(_entries.Size() + count);
+            for(size_t i = 0; i < count; i++)
+            {
+                const auto pair = asPair(list->GetItem(i));
+                _entries.Set(resolveReference(pair->GetItem(0)),resolveReference(pair->GetItem(1)));
+            }
+
+            return;
+        }
+
+        throw makeException(scope,"Cannot update a dictionary from " + source->ToString(scope));
     }
 
     std::shared_ptr<Object> Dictionary::Get(const std::shared_ptr<Object>& key,
                                             const std::shared_ptr<ScopeLike>& scope) const
     {
-        if(_entries.contains(key))
+        if(const auto found = _entries.Find(key))
         {
-            return _entries.at(key);
+            return *found;
         }
         
         return DynamicObject::Get(key, scope);
     }
 
+    void Dictionary::Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& val,
+                         const std::shared_ptr<ScopeLike>& scope)
+    {
+        _entries.Set(key,val);
+    }
+
+    ObjectMap& Dictionary::GetNative()
+    {
+        return _entries;
+    }
+
     std::string Dictionary::ToString(const std::shared_ptr<ScopeLike>& scopeLike) const
     {
         std::string result = "{ ";
+        size_t written = 0;
 
-        for(auto it = _entries.begin(); it != _entries.end(); ++it)
+        // Entries print in insertion order
+        for(auto &entry : _entries)
         {
-            const auto [key,val] = *it;
+            result += entry.key->ToString(scopeLike) + " => " +  entry.value->ToString(scopeLike);
             
-            result += key->ToString(scopeLike) + " => " +  val->ToString(scopeLike);
-            
-            if(std::next(it) != _entries.end())
+            if(++written != _entries.Size())
             {
                 result += " , ";
             }
@@ -83,6 +292,101 @@ namespace spp::runtime
         return result;
     }
 
+    bool DictionaryView::HasNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Has(id) || Iterator::GetMethods().Has(id);
+    }
+
+    std::shared_ptr<Function> DictionaryView::BindNativeMethod(const std::string& id) const
+    {
+        if(GetMethods().Has(id))
+        {
+            return GetMethods().Bind(id,this);
+        }
+
+        // map, filter and friends start a fresh pass over the dictionary
+        return Iterator::GetMethods().Bind(id,MakeIterator().get());
+    }
+
+    DictionaryView::DictionaryView(const std::shared_ptr<Dictionary>& dict, EDictionaryView view) : DynamicObject({}), _dict(dict), _view(view)
+    {
+    }
+
+    const NativeMethodTable<DictionaryView>& DictionaryView::GetMethods()
+    {
+        static const auto methods = NativeMethodTable<DictionaryView>()
+            .Add("iter",vectorOf<std::string>(),&DictionaryView::Iter)
+            .Add("size",vectorOf<std::string>(),&DictionaryView::Size)
+            .Add("has",vectorOf<std::string>("item"),&DictionaryView::Has);
+
+        return methods;
+    }
+
+    std::shared_ptr<Iterator> DictionaryView::MakeIterator() const
+    {
+        return makeDictionaryIterator(_dict,_view);
+    }
+
+    std::shared_ptr<Object> DictionaryView::Iter(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return MakeIterator();
+    }
+
+    std::shared_ptr<Object> DictionaryView::Size(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeNumber(static_cast<int64_t>(_dict->GetNative().Size()));
+    }
+
+    std::shared_ptr<Object> DictionaryView::Has(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto item = resolveReference(fnScope->GetArgument(0));
+        const auto& entries = _dict->GetNative();
+        switch (_view)
+        {
+        case EDictionaryView::Keys:
+            return makeBoolean(entries.Contains(item));
+        case EDictionaryView::Values:
+            for(auto &entry : entries)
+            {
+                if(entry.value->Equal(item,fnScope))
+                {
+                    return makeBoolean(true);
+                }
+            }
+            return makeBoolean(false);
+        case EDictionaryView::Items:
+            if(const auto pair = asPair(item))
+            {
+                const auto found = entries.Find(resolveReference(pair->GetItem(0)));
+                return makeBoolean(found && (*found)->Equal(resolveReference(pair->GetItem(1)),fnScope));
+            }
+            return makeBoolean(false);
+        }
+
+        return makeBoolean(false);
+    }
+
+    std::string DictionaryView::ToString(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        std::string result = "[";
+        const auto iterator = MakeIterator();
+        std::shared_ptr<Object> value;
+        bool first = true;
+        while(iterator->Next(value,scope))
+        {
+            result += first ? "" : " , ";
+            result += value->GetType() == EObjectType::String ? "\"" + value->ToString(scope) + "\"" : value->ToString(scope);
+            first = false;
+        }
+
+        return result + "]";
+    }
+
+    std::shared_ptr<Iterator> makeDictionaryIterator(const std::shared_ptr<Dictionary>& dict, EDictionaryView view)
+    {
+        return makeObject<DictionaryIterator>(dict,view);
+    }
+
     std::shared_ptr<Dictionary> makeDictionary(const std::unordered_map<std::shared_ptr<Object>, std::shared_ptr<Object>>& data)
     {
         return makeObject<Dictionary>(data);
@@ -94,7 +398,7 @@ namespace spp::runtime
         
         for (auto &[id,obj] : data)
         {
-            mapData.insert_or_assign(makeString(id),obj);
+            mapData.insert_or_assign(makeInternedString(id),obj);
         }
 
         return makeDictionary(mapData);
@@ -118,7 +422,15 @@ namespace spp::runtime
 
     std::shared_ptr<DynamicObject> DictionaryPrototype::CreateInstance(std::shared_ptr<FunctionScope>& scope)
     {
-        return makeDictionary();
+        auto dict = makeDictionary();
+
+        // Dict(other) copies, Dict([[k , v] , ...]) builds from pairs
+        for(auto &arg : scope->GetPositionalArgs())
+        {
+            dict->Merge(resolveReference(arg),scope);
+        }
+
+        return dict;
     }
 
     std::string DictionaryPrototype::GetName() const
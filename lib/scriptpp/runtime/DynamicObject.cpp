@@ -9,10 +9,29 @@ namespace spp::runtime
 {
     
     
+    std::shared_ptr<ScopeLike> DynamicObject::GetSelfScope()
+    {
+        if(!_selfFunctionScope)
+        {
+            _selfFunctionScope = makeRefScopeProxy(cast<DynamicObject>(this->GetRef()));
+        }
+        
+        return _selfFunctionScope;
+    }
+
+    bool DynamicObject::HasNativeMethod(const std::string& id) const
+    {
+        return false;
+    }
+
+    std::shared_ptr<Function> DynamicObject::BindNativeMethod(const std::string& id) const
+    {
+        return {};
+    }
+
     void DynamicObject::Init()
     {
         Object::Init();
-        _selfFunctionScope = makeRefScopeProxy(cast<DynamicObject>(this->GetRef()));
     }
 
     DynamicObject::DynamicObject(const std::shared_ptr<ScopeLike>& scope)
@@ -98,7 +117,7 @@ namespace spp::runtime
 
     bool DynamicObject::Has(const std::string& id, bool searchParent) const
     {
-        return _properties.contains(id);
+        return _properties.contains(id) || HasNativeMethod(id);
     }
 
     void DynamicObject::Assign(const std::string& id, const std::shared_ptr<Object>& var)
@@ -118,6 +137,11 @@ namespace spp::runtime
             return makeReferenceWithId(id,cast<DynamicObject>(this->GetRef()),_properties.at(id));
         }
 
+        if(auto method = BindNativeMethod(id))
+        {
+            return makeReferenceWithId(id,cast<DynamicObject>(this->GetRef()),method);
+        }
+
         if(searchParent && _outer)
         {
             return _outer->Find(id);
@@ -126,13 +150,13 @@ namespace spp::runtime
         return makeReferenceWithId(id,cast<DynamicObject>(this->GetRef()),makeNull());
     }
 
-    std::list<EScopeType> DynamicObject::GetScopeStack() const
+    ScopeTypeMask DynamicObject::GetScopeMask() const
     {
         if(_outer)
         {
-            return _outer->GetScopeStack();
+            return _outer->GetScopeMask();
         }
-        return {};
+        return 0;
     }
 
     bool DynamicObject::HasScopeType(EScopeType type) const
@@ -194,7 +218,12 @@ namespace spp::runtime
     void DynamicObject::AddLambda(const std::string& name, const std::vector<std::string>& args,
                                   const std::function<std::shared_ptr<Object>(std::shared_ptr<FunctionScope>&)>& func)
     {
-        DynamicObject::Set(name, makeNativeFunction(_selfFunctionScope, name, args,func, false));
+        DynamicObject::Set(name, makeNativeFunction(GetSelfScope(), name, args,func, false));
+    }
+
+    void DynamicObject::AddNative(const std::string& name, const std::vector<std::string>& args, NativeFunctionPointer func)
+    {
+        DynamicObject::Set(name, makeFastNativeFunction(GetSelfScope(), name, args, func, false));
     }
 
     std::shared_ptr<ScopeLike> DynamicObject::GetOuter() const
@@ -33,14 +33,11 @@ namespace spp::runtime
         {
             if(const auto asCallScope = cast<CallScope>(next))
             {
+                // Natives called without a frame leave a call scope with no function in front of it
                 if(const auto function = lastFunction ? lastFunction->GetFunction().lock() : std::shared_ptr<Function>{})
                 {
                     callstackVec.emplace_back(makeString(function->ToString(scope) + " @ " + asCallScope->ToString()));
                 }
-                else
-                {
-                    continue;
-                }
                 
                 next = asCallScope->GetActual();
                 lastFunction = {};
@@ -1,57 +1,271 @@
 #include "scriptpp/runtime/Function.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 #include "scriptpp/utils.hpp"
 #include "scriptpp/runtime/Dictionary.hpp"
 #include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/FramePool.hpp"
 #include "scriptpp/runtime/eval.hpp"
 #include "scriptpp/runtime/List.hpp"
 #include "scriptpp/runtime/Null.hpp"
+#include "scriptpp/runtime/String.hpp"
 
 namespace spp::runtime
 {
 
-    FunctionScope::FunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::vector<std::shared_ptr<frontend::ParameterNode>>& parameters,const std::unordered_map<std::string,std::shared_ptr<Object>>& args,const std::vector<std::shared_ptr<Object>>& positionalArgs): Scope(declarationScope)
+    namespace
+    {
+        // Reads and writes a parameter slot of the scope it came from
+        class ArgumentReference : public Reference
+        {
+            size_t _slot;
+        public:
+            ArgumentReference(const std::shared_ptr<FunctionScope>& scope,size_t slot,const std::shared_ptr<Object>& val) : Reference(scope,val), _slot(slot)
+            {
+            }
+
+            void Set(const std::shared_ptr<Object>& val) override
+            {
+                Reference::Set(val);
+                castStatic<FunctionScope>(_scope)->SetSlot(_slot,val);
+            }
+        };
+    }
+
+    ParameterLayout::ParameterLayout(const std::vector<std::shared_ptr<frontend::ParameterNode>>& params)
+    {
+        names.reserve(params.size());
+        for (auto &param : params)
+        {
+            names.push_back(param->name);
+        }
+    }
+
+    int32_t ParameterLayout::FindSlot(const std::string& id) const
+    {
+        // Parameter lists are short, a scan beats hashing the id
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if(names[i] == id)
+            {
+                return static_cast<int32_t>(i);
+            }
+        }
+
+        return -1;
+    }
+
+    FunctionScope::FunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout): Scope(declarationScope,ST_Function)
+    {
+        Bind(fn,callScope,layout);
+    }
+
+    FunctionScope::FunctionScope(const std::weak_ptr<Function>& fn,const std::shared_ptr<ScopeLike>& callScope,const std::shared_ptr<ScopeLike>& declarationScope,const std::shared_ptr<const ParameterLayout>& layout,std::vector<std::shared_ptr<Object>>&& positionalArgs,NamedArguments&& namedArgs): Scope(declarationScope,ST_Function)
+    {
+        Bind(fn,callScope,layout,std::move(positionalArgs),std::move(namedArgs));
+    }
+
+    void FunctionScope::Bind(const std::weak_ptr<Function>& fn, const std::shared_ptr<ScopeLike>& callScope,
+        const std::shared_ptr<const ParameterLayout>& layout)
     {
         _fn = fn;
         _callerScope = callScope;
-        _arguments = args;
-        _positionalArguments = positionalArgs;
-        
-        for (auto i = 0; i < parameters.size() && i < positionalArgs.size(); i++)
+        _layout = layout;
+    }
+
+    void FunctionScope::Bind(const std::weak_ptr<Function>& fn, const std::shared_ptr<ScopeLike>& callScope,
+        const std::shared_ptr<const ParameterLayout>& layout, std::vector<std::shared_ptr<Object>>&& positionalArgs,
+        NamedArguments&& namedArgs)
+    {
+        Bind(fn,callScope,layout);
+        _arguments = std::move(positionalArgs);
+        _namedArguments = std::move(namedArgs);
+        BindArguments();
+    }
+
+    std::vector<std::shared_ptr<Object>>& FunctionScope::GetArgumentStorage()
+    {
+        return _arguments;
+    }
+
+    NamedArguments& FunctionScope::GetNamedArgumentStorage()
+    {
+        return _namedArguments;
+    }
+
+    void FunctionScope::BindArguments()
+    {
+        _positionalCount = _arguments.size();
+
+        // Named arguments fill the parameters that were not passed positionally
+        if(_positionalCount < _layout->names.size())
         {
-            _arguments.insert_or_assign(std::to_string(i),_positionalArguments.at(i));
-            _arguments.insert_or_assign(parameters.at(i)->name,_positionalArguments.at(i));
-        } 
+            _arguments.resize(_layout->names.size());
+            for (auto &[id,arg] : _namedArguments)
+            {
+                if(const auto slot = _layout->FindSlot(id); slot >= static_cast<int32_t>(_positionalCount))
+                {
+                    _arguments[slot] = arg;
+                }
+            }
+        }
     }
 
-    EScopeType FunctionScope::GetScopeType() const
+    std::shared_ptr<Object> FunctionScope::FindImplicit(const std::string& id) const
     {
-        return ST_Function;
+        const auto self = cast<FunctionScope>(this->GetRef());
+        if(id == ARGUMENTS_KEY)
+        {
+            if(!_argumentsList)
+            {
+                const auto args = GetPositionalArgs();
+                _argumentsList = makeList(std::vector(args.begin(),args.end()));
+            }
+
+            return makeReferenceWithId(id,self,_argumentsList);
+        }
+
+        if(id == NAMED_ARGUMENTS_KEY)
+        {
+            if(!_namedArgumentsDict)
+            {
+                const auto dict = makeDictionary();
+                for (auto &[key,arg] : _namedArguments)
+                {
+                    dict->GetNative().Set(makeInternedString(key),arg);
+                }
+                _namedArgumentsDict = dict;
+            }
+
+            return makeReferenceWithId(id,self,_namedArgumentsDict);
+        }
+
+        if(id == THIS_KEY)
+        {
+            const auto fn = _fn.lock();
+            return makeReferenceWithId(id,self,fn ? fn->GetOwner() : std::shared_ptr<Object>{});
+        }
+
+        return {};
     }
 
     std::shared_ptr<Object> FunctionScope::Find(const std::string& id, bool searchParent) const
     {
-        if(_arguments.contains(id))
+        if(const auto slot = _layout->FindSlot(id); slot != -1 && _arguments[slot])
         {
-            return _arguments.at(id);
+            // Arguments that already are references (list items) are written through
+            const auto& arg = _arguments[slot];
+            if(arg->GetType() == EObjectType::Reference)
+            {
+                return arg;
+            }
+
+            return makeObject<ArgumentReference>(cast<FunctionScope>(this->GetRef()),slot,arg);
         }
-        return Scope::Find(id);
+
+        for (auto &[key,arg] : _namedArguments)
+        {
+            if(key == id)
+            {
+                return arg;
+            }
+        }
+
+        // Anything assigned in the body shadows the implicit values
+        if(auto local = Scope::Find(id,false))
+        {
+            return local;
+        }
+
+        if(auto implicit = FindImplicit(id))
+        {
+            return implicit;
+        }
+
+        if(const auto outer = GetOuter())
+        {
+            return outer->Find(id);
+        }
+
+        return {};
+    }
+
+    bool FunctionScope::Has(const std::string& id, bool searchParent) const
+    {
+        if(const auto slot = _layout->FindSlot(id); slot != -1 && _arguments[slot])
+        {
+            return true;
+        }
+
+        for (auto &[key,arg] : _namedArguments)
+        {
+            if(key == id)
+            {
+                return true;
+            }
+        }
+
+        if(id == ARGUMENTS_KEY || id == NAMED_ARGUMENTS_KEY || id == THIS_KEY)
+        {
+            return true;
+        }
+
+        return Scope::Has(id,searchParent);
+    }
+
+    void FunctionScope::Assign(const std::string& id, const std::shared_ptr<Object>& var)
+    {
+        if(const auto slot = _layout->FindSlot(id); slot != -1)
+        {
+            SetSlot(slot,var);
+            return;
+        }
+
+        Scope::Assign(id,var);
+    }
+
+    void FunctionScope::Create(const std::string& id, const std::shared_ptr<Object>& var)
+    {
+        if(const auto slot = _layout->FindSlot(id); slot != -1)
+        {
+            SetSlot(slot,var);
+            return;
+        }
+
+        Scope::Create(id,var);
+    }
+
+    void FunctionScope::SetSlot(size_t slot, const std::shared_ptr<Object>& var)
+    {
+        _arguments[slot] = var;
     }
     
     std::shared_ptr<Object> FunctionScope::FindArgument(const std::string& id,bool required)
     {
-        if(!_arguments.contains(id)) throw makeException({},"Missing required argument : " + id);
+        if(const auto slot = _layout->FindSlot(id); slot != -1 && _arguments[slot])
+        {
+            return _arguments[slot];
+        }
 
-        return _arguments.at(id);
+        for (auto &[key,arg] : _namedArguments)
+        {
+            if(key == id)
+            {
+                return arg;
+            }
+        }
+
+        throw makeException({},"Missing required argument : " + id);
     }
 
     std::shared_ptr<Object> FunctionScope::GetArgument(const uint32_t& index)
     {
-        if(index >= _positionalArguments.size()) return makeNull();
+        if(index >= _positionalCount) return makeNull();
 
-        return _positionalArguments.at(index);
+        return _arguments[index];
     }
 
     std::string FunctionScope::ARGUMENTS_KEY = "__args__";
@@ -64,14 +278,14 @@ namespace spp::runtime
         return _fn;
     }
 
-    std::unordered_map<std::string,std::shared_ptr<Object>> FunctionScope::GetNamedArgs() const
+    const NamedArguments& FunctionScope::GetNamedArgs() const
     {
-        return _arguments;
+        return _namedArguments;
     }
 
-    std::vector<std::shared_ptr<Object>> FunctionScope::GetPositionalArgs() const
+    std::span<const std::shared_ptr<Object>> FunctionScope::GetPositionalArgs() const
     {
-        return _positionalArguments;
+        return {_arguments.data(),_positionalCount};
     }
 
     std::shared_ptr<ScopeLike> FunctionScope::GetCallerScope() const
@@ -79,13 +293,141 @@ namespace spp::runtime
         return _callerScope;
     }
 
+    void FunctionScope::SetResult(const std::shared_ptr<Object>& result)
+    {
+        _result = result;
+    }
+
+    std::shared_ptr<Object> FunctionScope::TakeResult()
+    {
+        auto result = std::move(_result);
+        _result = {};
+        return result ? result : makeNull();
+    }
+
+    void FunctionScope::SetTailCall(TailCall&& tailCall)
+    {
+        _tailCall = std::move(tailCall);
+    }
+
+    bool FunctionScope::TakeTailCall(TailCall& out)
+    {
+        if(!_tailCall)
+        {
+            return false;
+        }
+
+        out = std::move(*_tailCall);
+        _tailCall.reset();
+        return true;
+    }
+
+    void FunctionScope::Reset(const std::weak_ptr<Function>& fn, const std::shared_ptr<ScopeLike>& callScope,
+        const std::shared_ptr<ScopeLike>& declarationScope, const std::shared_ptr<const ParameterLayout>& layout)
+    {
+        Rebind(declarationScope);
+        Bind(fn,callScope,layout);
+    }
+
+    void FunctionScope::Reset(const std::weak_ptr<Function>& fn, const std::shared_ptr<ScopeLike>& callScope,
+        const std::shared_ptr<ScopeLike>& declarationScope, const std::shared_ptr<const ParameterLayout>& layout,
+        std::vector<std::shared_ptr<Object>>&& positionalArgs, NamedArguments&& namedArgs)
+    {
+        Rebind(declarationScope);
+        Bind(fn,callScope,layout,std::move(positionalArgs),std::move(namedArgs));
+    }
+
+    void FunctionScope::Release()
+    {
+        Clear();
+        _layout.reset();
+        _arguments.clear();
+        _positionalCount = 0;
+        _namedArguments.clear();
+        _argumentsList.reset();
+        _namedArgumentsDict.reset();
+        _result.reset();
+        _tailCall.reset();
+        _fn.reset();
+        _callerScope.reset();
+    }
+
+    std::shared_ptr<FunctionScope> findFunctionScope(const std::shared_ptr<ScopeLike>& scope)
+    {
+        for(auto next = scope; next; next = next->GetOuter())
+        {
+            if(next->GetScopeType() == ST_Function)
+            {
+                return cast<FunctionScope>(next);
+            }
+        }
+
+        return {};
+    }
+
+    std::shared_ptr<FunctionScope> makeFunctionScope(const std::weak_ptr<Function>& fn,
+        const std::shared_ptr<ScopeLike>& callScope, const std::shared_ptr<ScopeLike>& declarationScope,
+        const std::shared_ptr<const ParameterLayout>& layout,
+        std::vector<std::shared_ptr<Object>>&& positionalArgs,
+        NamedArguments&& namedArgs)
+    {
+        if(auto frame = FramePool<FunctionScope>::Get().Take())
+        {
+            frame->Reset(fn,callScope,declarationScope,layout,std::move(positionalArgs),std::move(namedArgs));
+            return frame;
+        }
+
+        return makeObject<FunctionScope>(fn,callScope,declarationScope,layout,std::move(positionalArgs),std::move(namedArgs)); 
+    }
+
     std::shared_ptr<FunctionScope> makeFunctionScope(const std::weak_ptr<Function>& fn,
         const std::shared_ptr<ScopeLike>& callScope, const std::shared_ptr<ScopeLike>& declarationScope,
-        const std::vector<std::shared_ptr<frontend::ParameterNode>>& parameters,
-        const std::unordered_map<std::string, std::shared_ptr<Object>>& args,
-        const std::vector<std::shared_ptr<Object>>& positionalArgs)
+        const std::shared_ptr<const ParameterLayout>& layout)
+    {
+        if(auto frame = FramePool<FunctionScope>::Get().Take())
+        {
+            frame->Reset(fn,callScope,declarationScope,layout);
+            return frame;
+        }
+
+        return makeObject<FunctionScope>(fn,callScope,declarationScope,layout);
+    }
+
+    void releaseFunctionScope(std::shared_ptr<FunctionScope>&& scope)
+    {
+        FramePool<FunctionScope>::Get().Return(std::move(scope));
+    }
+
+    std::shared_ptr<Object> runTailCalls(TailCall&& tailCall)
     {
-        return makeObject<FunctionScope>(fn,callScope,declarationScope,parameters,args,positionalArgs); 
+        // Every hop gets its frame from this loop instead of from the frame before it, so the native stack and the
+        // number of live frames stay the same however long the chain is
+        std::shared_ptr<Object> result{};
+        std::shared_ptr<FunctionScope> frame{};
+        std::shared_ptr<CallScope> callScope{};
+        auto next = std::move(tailCall);
+        do
+        {
+            releaseFunctionScope(std::move(frame));
+            releaseCallScope(std::move(callScope));
+
+            const auto fn = std::move(next.fn);
+            callScope = std::move(next.callScope);
+            frame = makeFunctionScope(fn,callScope,fn->GetDeclarationScope(),fn->GetLayout(),std::move(next.positionalArgs),std::move(next.namedArgs));
+            if(const auto runtimeFn = cast<RuntimeFunction>(fn))
+            {
+                result = runtimeFn->RunBody(frame);
+            }
+            else
+            {
+                result = fn->HandleCall(frame);
+            }
+        }
+        while(frame->TakeTailCall(next));
+
+        releaseFunctionScope(std::move(frame));
+        releaseCallScope(std::move(callScope));
+        return result;
     }
 
     Function::Function(const std::shared_ptr<ScopeLike>& declarationScope, const std::string& name, const std::vector<std::shared_ptr<frontend::ParameterNode>>& params)
@@ -93,6 +435,7 @@ namespace spp::runtime
         _declarationScope = declarationScope;
         _name = name;
         _params = params;
+        _layout = std::make_shared<ParameterLayout>(_params);
     }
 
     Function::Function(const std::shared_ptr<ScopeLike>& declarationScope, const std::string& name,
@@ -105,6 +448,16 @@ namespace spp::runtime
         {
             _params.push_back(std::make_shared<frontend::ParameterNode>(frontend::TokenDebugInfo{},param));
         }
+        _layout = std::make_shared<ParameterLayout>(_params);
+    }
+
+    Function::Function(const std::shared_ptr<ScopeLike>& declarationScope, const std::string& name,
+        const std::vector<std::shared_ptr<frontend::ParameterNode>>& params, const std::shared_ptr<const ParameterLayout>& layout)
+    {
+        _declarationScope = declarationScope;
+        _name = name;
+        _params = params;
+        _layout = layout;
     }
 
     EObjectType Function::GetType() const
@@ -131,14 +484,20 @@ namespace spp::runtime
         return "fn " + _name +  + "(" + join(strParams,",") + ")";
     }
 
-    std::shared_ptr<Object> Function::Call(const std::vector<std::shared_ptr<Object>>& positionalArgs, const std::unordered_map<std::string, std::shared_ptr<Object>>& namedArgs,const std::shared_ptr<ScopeLike>& callScope)
+    std::shared_ptr<Object> Function::Call(std::vector<std::shared_ptr<Object>> positionalArgs,NamedArguments namedArgs,const std::shared_ptr<ScopeLike>& callScope)
     {
         const auto myRef = cast<Function>(this->GetRef());
-        auto fnScope =  makeFunctionScope(myRef,callScope ? callScope : makeCallScope(),_declarationScope,_params,namedArgs,positionalArgs);
-        fnScope->Create(FunctionScope::ARGUMENTS_KEY,makeList(positionalArgs));
-        fnScope->Create(FunctionScope::NAMED_ARGUMENTS_KEY,makeDictionary(namedArgs));
-        fnScope->Create(FunctionScope::THIS_KEY,GetOwner());
-        return HandleCall(fnScope);
+        auto fnScope =  makeFunctionScope(myRef,callScope ? callScope : makeCallScope(),_declarationScope,_layout,std::move(positionalArgs),std::move(namedArgs));
+        auto result = HandleCall(fnScope);
+
+        // The frame is reused unless the body let something capture it
+        releaseFunctionScope(std::move(fnScope));
+        return result;
+    }
+
+    bool Function::IsCalledThroughFrame() const
+    {
+        return true;
     }
 
     std::shared_ptr<ScopeLike> Function::GetDeclarationScope() const
@@ -146,6 +505,11 @@ namespace spp::runtime
         return _declarationScope;
     }
 
+    std::shared_ptr<const ParameterLayout> Function::GetLayout() const
+    {
+        return _layout;
+    }
+
     bool Function::IsCallable() const
     {
         return true;
@@ -177,9 +541,28 @@ namespace spp::runtime
         _function = function;
     }
 
+    std::shared_ptr<Object> RuntimeFunction::RunBody(std::shared_ptr<FunctionScope>& scope)
+    {
+        const auto result = runScope(_function->body,scope);
+        
+        if(result->GetType() == EObjectType::ReturnValue)
+        {
+            return scope->TakeResult();
+        }
+
+        return result;
+    }
+
     std::shared_ptr<Object> RuntimeFunction::HandleCall(std::shared_ptr<FunctionScope>& scope)
     {
-        return runScope(_function->body,scope);
+        auto result = RunBody(scope);
+
+        if(TailCall tailCall; scope->TakeTailCall(tailCall))
+        {
+            return runTailCalls(std::move(tailCall));
+        }
+
+        return result;
     }
 
     std::shared_ptr<Function> RuntimeFunction::Clone()
@@ -189,6 +572,11 @@ namespace spp::runtime
         return result;
     }
 
+    std::shared_ptr<frontend::FunctionNode> RuntimeFunction::GetNode() const
+    {
+        return _function;
+    }
+
     NativeFunction::NativeFunction(const std::shared_ptr<ScopeLike>& scope, const std::string& name,
                                    const std::vector<std::string>& params, const NativeFunctionType& func) : Function(scope,name,params)
     {
@@ -220,6 +608,62 @@ namespace spp::runtime
         return result;
     }
 
+    std::shared_ptr<ScopeLike> findCaptureScope(const std::shared_ptr<ScopeLike>& scope, const frontend::FunctionNode& function)
+    {
+        if(!scope || !function.enclosingVariables.empty())
+        {
+            return scope;
+        }
+
+        // How many scopes out the innermost variable the body uses lives, the outermost scope is kept when it uses none
+        size_t innermost = std::numeric_limits<size_t>::max();
+        for (auto &id : function.freeVariables)
+        {
+            // The owner is only held weakly by the function, the declaration scope is what keeps an instance alive
+            // while one of its methods runs, e.g. P().set(1).get()
+            if(id == FunctionScope::THIS_KEY)
+            {
+                return scope;
+            }
+
+            // Always answered by the closure's own frame
+            if(id == FunctionScope::ARGUMENTS_KEY || id == FunctionScope::NAMED_ARGUMENTS_KEY)
+            {
+                continue;
+            }
+
+            size_t depth = 0;
+            auto next = scope;
+            while(next && !next->Has(id,false))
+            {
+                next = next->GetOuter();
+                ++depth;
+            }
+
+            if(!next || depth == 0)
+            {
+                return scope;
+            }
+
+            innermost = std::min(innermost,depth);
+        }
+
+        // Names declared later at the top of a module land in the module scope, it stays alive anyway
+        auto result = scope;
+        for(size_t depth = 0; depth < innermost && result->GetScopeType() != ST_Module; ++depth)
+        {
+            auto outer = result->GetOuter();
+            if(!outer)
+            {
+                break;
+            }
+
+            result = std::move(outer);
+        }
+
+        return result;
+    }
+
     std::shared_ptr<RuntimeFunction> makeRuntimeFunction(const std::shared_ptr<ScopeLike>& scope,
                                                          const std::shared_ptr<frontend::FunctionNode>& function, bool addToScope)
     {
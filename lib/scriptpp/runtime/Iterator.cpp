@@ -0,0 +1,379 @@
+#include "scriptpp/runtime/Iterator.hpp"
+
+#include "scriptpp/utils.hpp"
+#include "scriptpp/runtime/eval.hpp"
+#include "scriptpp/runtime/Dictionary.hpp"
+#include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/List.hpp"
+#include "scriptpp/runtime/Null.hpp"
+#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/String.hpp"
+#include "scriptpp/runtime/Tuple.hpp"
+
+namespace spp::runtime
+{
+    namespace
+    {
+        class ListIterator : public Iterator
+        {
+            std::shared_ptr<List> _list;
+            size_t _index = 0;
+        public:
+            explicit ListIterator(const std::shared_ptr<List>& list) : _list(list)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                if (_index >= _list->GetSize())
+                {
+                    return false;
+                }
+
+                value = _list->GetItem(_index++);
+                return true;
+            }
+        };
+
+        class TupleIterator : public Iterator
+        {
+            std::shared_ptr<Tuple> _tuple;
+            size_t _index = 0;
+        public:
+            explicit TupleIterator(const std::shared_ptr<Tuple>& tuple) : _tuple(tuple)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                if (_index >= _tuple->GetSize())
+                {
+                    return false;
+                }
+
+                value = _tuple->GetItems()[_index++];
+                return true;
+            }
+        };
+
+        class StringIterator : public Iterator
+        {
+            std::shared_ptr<String> _str;
+            size_t _index = 0;
+        public:
+            explicit StringIterator(const std::shared_ptr<String>& str) : _str(str)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                const auto view = _str->GetView();
+                if (_index >= view.size())
+                {
+                    return false;
+                }
+
+                value = makeCharString(view[_index++]);
+                return true;
+            }
+        };
+
+        class MapIterator : public Iterator
+        {
+            std::shared_ptr<Iterator> _source;
+            std::shared_ptr<Function> _fn;
+            int64_t _index = 0;
+        public:
+            MapIterator(const std::shared_ptr<Iterator>& source,const std::shared_ptr<Function>& fn) : _source(source), _fn(fn)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                if (!_source->Next(value,scope))
+                {
+                    return false;
+                }
+
+                value = resolveReference(_fn->Call(scope,value,makeNumber(_index++)));
+                return true;
+            }
+        };
+
+        class FilterIterator : public Iterator
+        {
+            std::shared_ptr<Iterator> _source;
+            std::shared_ptr<Function> _fn;
+            int64_t _index = 0;
+        public:
+            FilterIterator(const std::shared_ptr<Iterator>& source,const std::shared_ptr<Function>& fn) : _source(source), _fn(fn)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                while (_source->Next(value,scope))
+                {
+                    if (resolveReference(_fn->Call(scope,value,makeNumber(_index++)))->ToBoolean(scope))
+                    {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+        };
+
+        class TakeIterator : public Iterator
+        {
+            std::shared_ptr<Iterator> _source;
+            int64_t _remaining;
+        public:
+            TakeIterator(const std::shared_ptr<Iterator>& source,int64_t count) : _source(source), _remaining(count)
+            {
+            }
+
+            // Stops pulling from the source as soon as enough values were produced
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                if (_remaining <= 0 || !_source->Next(value,scope))
+                {
+                    return false;
+                }
+
+                _remaining--;
+                return true;
+            }
+        };
+
+        class SkipIterator : public Iterator
+        {
+            std::shared_ptr<Iterator> _source;
+            int64_t _toSkip;
+        public:
+            SkipIterator(const std::shared_ptr<Iterator>& source,int64_t count) : _source(source), _toSkip(count)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                for (; _toSkip > 0; _toSkip--)
+                {
+                    if (!_source->Next(value,scope))
+                    {
+                        return false;
+                    }
+                }
+
+                return _source->Next(value,scope);
+            }
+        };
+
+        // Yields [a , b] pairs until either side runs out
+        class ZipIterator : public Iterator
+        {
+            std::shared_ptr<Iterator> _left;
+            std::shared_ptr<Iterator> _right;
+        public:
+            ZipIterator(const std::shared_ptr<Iterator>& left,const std::shared_ptr<Iterator>& right) : _left(left), _right(right)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                std::shared_ptr<Object> left;
+                std::shared_ptr<Object> right;
+                if (!_left->Next(left,scope) || !_right->Next(right,scope))
+                {
+                    return false;
+                }
+
+                value = makeList(vectorOf<std::shared_ptr<Object>>(left,right));
+                return true;
+            }
+        };
+
+        // Yields [index , value] pairs
+        class EnumerateIterator : public Iterator
+        {
+            std::shared_ptr<Iterator> _source;
+            int64_t _index = 0;
+        public:
+            explicit EnumerateIterator(const std::shared_ptr<Iterator>& source) : _source(source)
+            {
+            }
+
+            bool Next(std::shared_ptr<Object>& value, const std::shared_ptr<ScopeLike>& scope) override
+            {
+                std::shared_ptr<Object> item;
+                if (!_source->Next(item,scope))
+                {
+                    return false;
+                }
+
+                value = makeList(vectorOf<std::shared_ptr<Object>>(makeNumber(_index++),item));
+                return true;
+            }
+        };
+
+        std::shared_ptr<Function> findCallbackArg(const std::shared_ptr<FunctionScope>& fnScope,const std::string& method)
+        {
+            if (const auto fn = cast<Function>(resolveReference(fnScope->GetArgument(0))))
+            {
+                return fn;
+            }
+
+            throw makeException(fnScope,"No Callback passed to " + method);
+        }
+
+        int64_t findCountArg(const std::shared_ptr<FunctionScope>& fnScope,const std::string& method)
+        {
+            const auto arg = resolveReference(fnScope->GetArgument(0));
+            if (arg->GetType() != EObjectType::Number)
+            {
+                throw makeException(fnScope,method + " expects a number");
+            }
+
+            return castStatic<Number>(arg)->GetValueAs<int64_t>();
+        }
+    }
+
+    bool Iterator::HasNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Has(id);
+    }
+
+    std::shared_ptr<Function> Iterator::BindNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Bind(id,this);
+    }
+
+    Iterator::Iterator() : DynamicObject({})
+    {
+    }
+
+    std::string Iterator::ToString(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        return "<Iterator>";
+    }
+
+    const NativeMethodTable<Iterator>& Iterator::GetMethods()
+    {
+        static const auto methods = NativeMethodTable<Iterator>()
+            .Add("iter",vectorOf<std::string>(),&Iterator::Iter)
+            .Add("map",vectorOf<std::string>("callback"),&Iterator::Map)
+            .Add("filter",vectorOf<std::string>("callback"),&Iterator::Filter)
+            .Add("take",vectorOf<std::string>("count"),&Iterator::Take)
+            .Add("skip",vectorOf<std::string>("count"),&Iterator::Skip)
+            .Add("zip",vectorOf<std::string>("other"),&Iterator::Zip)
+            .Add("enumerate",vectorOf<std::string>(),&Iterator::Enumerate)
+            .Add("collect",vectorOf<std::string>(),&Iterator::Collect)
+            .Add("next",vectorOf<std::string>(),&Iterator::NextValue);
+
+        return methods;
+    }
+
+    std::shared_ptr<Object> Iterator::Iter(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return this->GetRef();
+    }
+
+    std::shared_ptr<Object> Iterator::Map(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<MapIterator>(cast<Iterator>(this->GetRef()),findCallbackArg(fnScope,"map"));
+    }
+
+    std::shared_ptr<Object> Iterator::Filter(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<FilterIterator>(cast<Iterator>(this->GetRef()),findCallbackArg(fnScope,"filter"));
+    }
+
+    std::shared_ptr<Object> Iterator::Take(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<TakeIterator>(cast<Iterator>(this->GetRef()),findCountArg(fnScope,"take"));
+    }
+
+    std::shared_ptr<Object> Iterator::Skip(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<SkipIterator>(cast<Iterator>(this->GetRef()),findCountArg(fnScope,"skip"));
+    }
+
+    std::shared_ptr<Object> Iterator::Zip(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto other = makeIterator(resolveReference(fnScope->GetArgument(0)),fnScope);
+        return makeObject<ZipIterator>(cast<Iterator>(this->GetRef()),other);
+    }
+
+    std::shared_ptr<Object> Iterator::Enumerate(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeObject<EnumerateIterator>(cast<Iterator>(this->GetRef()));
+    }
+
+    std::shared_ptr<Object> Iterator::Collect(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        std::vector<std::shared_ptr<Object>> items;
+        std::shared_ptr<Object> value;
+        while (Next(value,fnScope))
+        {
+            items.push_back(value);
+        }
+
+        return makeList(items);
+    }
+
+    std::shared_ptr<Object> Iterator::NextValue(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        std::shared_ptr<Object> value;
+        return Next(value,fnScope) ? value : makeNull();
+    }
+
+    std::shared_ptr<Iterator> makeIterator(const std::shared_ptr<Object>& source, const std::shared_ptr<ScopeLike>& scope)
+    {
+        if (const auto iterator = cast<Iterator>(source))
+        {
+            return iterator;
+        }
+
+        if (const auto list = cast<List>(source))
+        {
+            return makeObject<ListIterator>(list);
+        }
+
+        if (const auto str = cast<String>(source))
+        {
+            return makeObject<StringIterator>(str);
+        }
+
+        if (const auto tuple = cast<Tuple>(source))
+        {
+            return makeObject<TupleIterator>(tuple);
+        }
+
+        // Dictionaries iterate their keys
+        if (const auto dict = cast<Dictionary>(source))
+        {
+            return makeDictionaryIterator(dict,EDictionaryView::Keys);
+        }
+
+        if (const auto view = cast<DictionaryView>(source))
+        {
+            return view->MakeIterator();
+        }
+
+        if (const auto obj = cast<DynamicObject>(source))
+        {
+            if (const auto impl = obj->Get("iter"))
+            {
+                if (auto [fn,callScope] = resolveCallable(resolveReference(impl),scope); fn)
+                {
+                    if (const auto iterator = cast<Iterator>(resolveReference(fn->Call(scope))))
+                    {
+                        return iterator;
+                    }
+                }
+            }
+        }
+
+        throw makeException(scope,source->ToString(scope) + " is not iterable");
+    }
+}
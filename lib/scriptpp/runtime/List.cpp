@@ -1,17 +1,138 @@
 ﻿#include "scriptpp/runtime/List.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <numeric>
 
+#include "scriptpp/numeric.hpp"
 #include "scriptpp/utils.hpp"
+#include "scriptpp/runtime/Boolean.hpp"
 #include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Iterator.hpp"
 #include "scriptpp/runtime/Null.hpp"
 #include "scriptpp/runtime/Number.hpp"
-#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/ObjectMap.hpp"
+#include "scriptpp/runtime/Parallel.hpp"
 #include "scriptpp/runtime/String.hpp"
 
 namespace spp::runtime
 {
+    namespace
+    {
+        std::shared_ptr<Object> findOptionalArg(const std::shared_ptr<FunctionScope>& fnScope,const std::string& id)
+        {
+            if(const auto arg = fnScope->Find(id))
+            {
+                return resolveReference(arg);
+            }
+
+            return makeNull();
+        }
+
+        // Callbacks for the parallel methods have to pass the isolation check before any thread runs them
+        std::shared_ptr<Function> findParallelCallback(const std::shared_ptr<FunctionScope>& fnScope,const std::string& method)
+        {
+            const auto fn = cast<Function>(resolveReference(fnScope->GetArgument(0)));
+            if (!fn)
+            {
+                throw makeException(fnScope,"No Callback passed to " + method);
+            }
+
+            ensureIsolated(method,fn,fnScope);
+            return fn;
+        }
+
+        // Orders NaN after every other number so sorting doubles stays a strict weak ordering
+        bool doubleLess(double a,double b)
+        {
+            return a < b || (std::isnan(b) && !std::isnan(a));
+        }
+
+        // Enough chunks per thread to even out callbacks of uneven cost
+        size_t parallelGrain(size_t count)
+        {
+            return std::max<size_t>(count / (WorkerPool::Get().GetSize() * 8),1);
+        }
+        
+        EListStorage getPackedStorage(const std::shared_ptr<Object>& item)
+        {
+            if(item->GetType() == EObjectType::Boolean)
+            {
+                return EListStorage::Boolean;
+            }
+            
+            if(item->GetType() != EObjectType::Number)
+            {
+                return EListStorage::Objects;
+            }
+
+            switch (castStatic<Number>(item)->GetNumberType())
+            {
+            case ENumberType::Int:
+            case ENumberType::Int64:
+                return EListStorage::Int64;
+            case ENumberType::Float:
+            case ENumberType::Double:
+                return EListStorage::Double;
+            }
+
+            return EListStorage::Objects;
+        }
+
+        template<typename T>
+        T getPackedValue(const std::shared_ptr<Object>& item)
+        {
+            if constexpr (std::is_same_v<T,bool>)
+            {
+                return item->ToBoolean({});
+            }
+            else
+            {
+                return castStatic<Number>(item)->GetValueAs<T>();
+            }
+        }
+
+        template<typename T>
+        void packInto(std::vector<T>& out,const std::vector<std::shared_ptr<Object>>& items)
+        {
+            out.reserve(items.size());
+            for(auto &item : items)
+            {
+                out.push_back(getPackedValue<T>(item));
+            }
+        }
+
+        template<typename T>
+        std::string packedToString(const T& value)
+        {
+            if constexpr (std::is_same_v<T,bool>)
+            {
+                return value ? "true" : "false";
+            }
+            else
+            {
+                return std::to_string(value);
+            }
+        }
+
+        template<typename T>
+        std::string joinPacked(const std::vector<T>& items,const std::string& delimiter)
+        {
+            std::string result;
+            for(size_t i = 0; i < items.size(); i++)
+            {
+                result += packedToString<T>(items[i]);
+                if(i != items.size() - 1)
+                {
+                    result += delimiter;
+                }
+            }
+
+            return result;
+        }
+    }
+    
     ListItemReference::ListItemReference(const size_t& index, const std::shared_ptr<ScopeLike>& scope,
         const std::shared_ptr<Object>& val) : Reference(scope,val)
     {
@@ -27,30 +148,276 @@ namespace spp::runtime
         }
     }
 
-    void List::Init()
+    bool List::HasNativeMethod(const std::string& id) const
     {
-        DynamicObject::Init();
+        return GetMethods().Has(id);
+    }
 
-        AddNativeMemberFunction("pop",this,vectorOf<std::string>(),&List::Pop);
-        AddNativeMemberFunction("push",this,vectorOf<std::string>(),&List::Push);
-        AddNativeMemberFunction("map",this,vectorOf<std::string>("callback"),&List::Map);
-        AddNativeMemberFunction("forEach",this,vectorOf<std::string>("callback"),&List::ForEach);
-        AddNativeMemberFunction("filter",this,vectorOf<std::string>("callback"),&List::Filter);
-        AddNativeMemberFunction("find",this,vectorOf<std::string>("callback"),&List::FindItem);
-        AddNativeMemberFunction("size",this,vectorOf<std::string>(),&List::Size);
-        AddNativeMemberFunction("join",this,vectorOf<std::string>("delimiter"),&List::Join);
-        AddNativeMemberFunction("findIndex",this,vectorOf<std::string>("callback"),&List::FindIndex);
-        AddNativeMemberFunction("sort",this,vectorOf<std::string>("callback"),&List::Sort);
-        AddNativeMemberFunction("reverse",this,vectorOf<std::string>(),&List::Reverse);
+    std::shared_ptr<Function> List::BindNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Bind(id,this);
     }
 
-    List::List(const std::vector<std::shared_ptr<Object>>& vec) : DynamicObject(makeScope())
+    List::List(const std::vector<std::shared_ptr<Object>>& vec) : DynamicObject({})
     {
         _vec = vec;
+        Pack();
+    }
+
+    List::List(std::vector<int64_t>&& vec) : DynamicObject({}), _storage(EListStorage::Int64), _ints(std::move(vec))
+    {
+    }
+
+    List::List(std::vector<double>&& vec) : DynamicObject({}), _storage(EListStorage::Double), _doubles(std::move(vec))
+    {
+    }
+
+    List::List(std::vector<bool>&& vec) : DynamicObject({}), _storage(EListStorage::Boolean), _bools(std::move(vec))
+    {
+    }
+
+    void List::Pack()
+    {
+        if(_storage != EListStorage::Objects || _vec.empty())
+        {
+            return;
+        }
+
+        const auto storage = getPackedStorage(_vec.front());
+        if(storage == EListStorage::Objects)
+        {
+            return;
+        }
+        
+        for(auto &item : _vec)
+        {
+            if(getPackedStorage(item) != storage)
+            {
+                return;
+            }
+        }
+
+        switch (storage)
+        {
+        case EListStorage::Int64:
+            packInto(_ints,_vec);
+            break;
+        case EListStorage::Double:
+            packInto(_doubles,_vec);
+            break;
+        case EListStorage::Boolean:
+            packInto(_bools,_vec);
+            break;
+        case EListStorage::Objects:
+            break;
+        }
+
+        _storage = storage;
+        _vec = {};
+    }
+
+    void List::Unpack()
+    {
+        if(_storage == EListStorage::Objects)
+        {
+            return;
+        }
+
+        std::vector<std::shared_ptr<Object>> items;
+        items.reserve(GetSize());
+        for(size_t i = 0; i < GetSize(); i++)
+        {
+            items.push_back(GetItem(i));
+        }
+
+        _ints = {};
+        _doubles = {};
+        _bools = {};
+        _vec = std::move(items);
+        _storage = EListStorage::Objects;
+    }
+
+    bool List::TryStorePacked(size_t index, const std::shared_ptr<Object>& val)
+    {
+        if(_storage == EListStorage::Objects || getPackedStorage(val) != _storage)
+        {
+            return false;
+        }
+
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            _ints[index] = getPackedValue<int64_t>(val);
+            break;
+        case EListStorage::Double:
+            _doubles[index] = getPackedValue<double>(val);
+            break;
+        case EListStorage::Boolean:
+            _bools[index] = getPackedValue<bool>(val);
+            break;
+        case EListStorage::Objects:
+            break;
+        }
+
+        return true;
+    }
+
+    bool List::TryAppendPacked(const std::shared_ptr<Object>& val)
+    {
+        // An empty generic list takes on the storage of its first item
+        if(_storage == EListStorage::Objects && _vec.empty())
+        {
+            _storage = getPackedStorage(val);
+        }
+        
+        if(_storage == EListStorage::Objects || getPackedStorage(val) != _storage)
+        {
+            return false;
+        }
+
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            _ints.push_back(getPackedValue<int64_t>(val));
+            break;
+        case EListStorage::Double:
+            _doubles.push_back(getPackedValue<double>(val));
+            break;
+        case EListStorage::Boolean:
+            _bools.push_back(getPackedValue<bool>(val));
+            break;
+        case EListStorage::Objects:
+            break;
+        }
+
+        return true;
+    }
+
+    bool List::IsPackedNumeric() const
+    {
+        return _storage == EListStorage::Int64 || _storage == EListStorage::Double;
+    }
+
+    std::vector<double> List::GetDoubles() const
+    {
+        if(_storage == EListStorage::Double)
+        {
+            return _doubles;
+        }
+        
+        return {_ints.begin(),_ints.end()};
+    }
+
+    std::shared_ptr<List> List::FindListArg(const std::shared_ptr<FunctionScope>& fnScope, const std::string& id) const
+    {
+        const auto other = cast<List>(resolveReference(fnScope->Find(id)));
+        if(!other)
+        {
+            throw makeException(fnScope,id + " must be a list");
+        }
+
+        if(other->GetSize() != GetSize())
+        {
+            throw makeException(fnScope,"Lists must have the same size");
+        }
+
+        return other;
+    }
+
+    EListStorage List::GetStorage() const
+    {
+        return _storage;
+    }
+
+    size_t List::GetSize() const
+    {
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            return _ints.size();
+        case EListStorage::Double:
+            return _doubles.size();
+        case EListStorage::Boolean:
+            return _bools.size();
+        case EListStorage::Objects:
+            break;
+        }
+        
+        return _vec.size();
+    }
+
+    std::shared_ptr<Object> List::GetItem(size_t index) const
+    {
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            return makeNumber(_ints[index]);
+        case EListStorage::Double:
+            return makeNumber(_doubles[index]);
+        case EListStorage::Boolean:
+            return makeBoolean(static_cast<bool>(_bools[index]));
+        case EListStorage::Objects:
+            break;
+        }
+        
+        return _vec[index];
+    }
+
+    void List::Append(const std::shared_ptr<Object>& val)
+    {
+        if(TryAppendPacked(val))
+        {
+            return;
+        }
+
+        Unpack();
+        _vec.push_back(val);
+    }
+
+    const NativeMethodTable<List>& List::GetMethods()
+    {
+        static const auto methods = NativeMethodTable<List>()
+            .Add("pop",vectorOf<std::string>(),bindNative<&List::Pop>())
+            .Add("push",vectorOf<std::string>(),bindNative<&List::Push>())
+            .Add("map",vectorOf<std::string>("callback"),&List::Map)
+            .Add("forEach",vectorOf<std::string>("callback"),&List::ForEach)
+            .Add("filter",vectorOf<std::string>("callback"),&List::Filter)
+            .Add("find",vectorOf<std::string>("callback"),&List::FindItem)
+            .Add("size",vectorOf<std::string>(),bindNative<&List::GetSize>())
+            .Add("join",vectorOf<std::string>("delimiter"),bindNative<&List::Join>())
+            .Add("findIndex",vectorOf<std::string>("callback"),&List::FindIndex)
+            .Add("sort",vectorOf<std::string>("callback","stable"),&List::Sort)
+            .Add("sortBy",vectorOf<std::string>("key","stable"),&List::SortBy)
+            .Add("reverse",vectorOf<std::string>(),bindNative<&List::Reverse>())
+            .Add("sum",vectorOf<std::string>(),bindNative<&List::Sum>())
+            .Add("min",vectorOf<std::string>(),bindNative<&List::Min>())
+            .Add("max",vectorOf<std::string>(),bindNative<&List::Max>())
+            .Add("mean",vectorOf<std::string>(),bindNative<&List::Mean>())
+            .Add("dot",vectorOf<std::string>("other"),&List::Dot)
+            .Add("scale",vectorOf<std::string>("factor"),&List::Scale)
+            .Add("add",vectorOf<std::string>("other"),&List::AddList)
+            .Add("parallelMap",vectorOf<std::string>("callback"),&List::ParallelMap)
+            .Add("parallelFilter",vectorOf<std::string>("callback"),&List::ParallelFilter)
+            .Add("parallelForEach",vectorOf<std::string>("callback"),&List::ParallelForEach)
+            .Add("iter",vectorOf<std::string>(),&List::Iter);
+        
+        return methods;
     }
 
     std::string List::ToString(const std::shared_ptr<ScopeLike>& scope) const
     {
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            return "[" + joinPacked(_ints," , ") + "]";
+        case EListStorage::Double:
+            return "[" + joinPacked(_doubles," , ") + "]";
+        case EListStorage::Boolean:
+            return "[" + joinPacked(_bools," , ") + "]";
+        case EListStorage::Objects:
+            break;
+        }
+        
         std::string result = "[";
         for(auto i = 0; i < _vec.size(); i++)
         {
@@ -67,19 +434,15 @@ namespace spp::runtime
 
     bool List::ToBoolean(const std::shared_ptr<ScopeLike>& scope) const
     {
-        return !_vec.empty();
+        return GetSize() != 0;
     }
 
     std::shared_ptr<Object> List::Get(const std::shared_ptr<Object>& key, const std::shared_ptr<ScopeLike>& scope) const
     {
         if(key->GetType() == EObjectType::Number)
         {
-            const auto i = cast<Number>(key)->GetValueAs<int>();
-            if(i >= _vec.size())
-            {
-                throw makeException(scope,"Index out of range " + std::to_string(i));
-            }
-            
+            const auto i = castStatic<Number>(key)->GetValueAs<int64_t>();
+            CheckIndex(i,scope);
             return makeListReference(this,i);
         }
         return DynamicObject::Get(key, scope);
@@ -89,12 +452,32 @@ namespace spp::runtime
     {
         if(key->GetType() == EObjectType::Number)
         {
-            Set(cast<Number>(key)->GetValueAs<int>(),val);
+            SetAt(castStatic<Number>(key)->GetValueAs<int64_t>(),val,scope);
             return;
         }
         DynamicObject::Set(key, val,scope);
     }
 
+    void List::CheckIndex(int64_t index, const std::shared_ptr<ScopeLike>& scope) const
+    {
+        if(index < 0 || index >= static_cast<int64_t>(GetSize()))
+        {
+            throw makeException(scope,"Index out of range " + std::to_string(index));
+        }
+    }
+
+    std::shared_ptr<Object> List::GetAt(int64_t index, const std::shared_ptr<ScopeLike>& scope) const
+    {
+        CheckIndex(index,scope);
+        return GetItem(index);
+    }
+
+    void List::SetAt(int64_t index, const std::shared_ptr<Object>& val, const std::shared_ptr<ScopeLike>& scope)
+    {
+        CheckIndex(index,scope);
+        Set(static_cast<size_t>(index),val);
+    }
+
     void List::Set(const std::string& key, const std::shared_ptr<Object>& val)
     {
         DynamicObject::Set(key, val);
@@ -102,34 +485,54 @@ namespace spp::runtime
 
     void List::Set(const size_t& index, const std::shared_ptr<Object>& val)
     {
-        if(index >= _vec.size())
+        if(index >= GetSize())
         {
             throw makeException({},"Index out of range " + std::to_string(index));
         }
 
+        if(TryStorePacked(index,val))
+        {
+            return;
+        }
+
+        Unpack();
         _vec[index] = val;
     }
 
-    std::shared_ptr<Object> List::Push(const std::shared_ptr<FunctionScope>& fnScope)
+    std::shared_ptr<Object> List::Push(NativeArgs items)
     {
-        for(auto &[_,arg] : fnScope->GetNamedArgs())
+        for(auto &item : items)
         {
-            _vec.push_back(resolveReference(arg));
+            Append(item);
         }
         
         return this->GetRef();
     }
 
-    std::shared_ptr<Object> List::Pop(const std::shared_ptr<FunctionScope>& fnScope)
+    std::shared_ptr<Object> List::Pop(NativeCallContext& ctx)
     {
-        if(_vec.empty())
+        if(GetSize() == 0)
         {
-            throw makeException(fnScope,"Attempted to pop from empty list");
+            throw makeException(ctx.GetScope(),"Attempted to pop from empty list");
         }
 
-        auto last = _vec.back();
+        auto last = GetItem(GetSize() - 1);
 
-        _vec.pop_back();
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            _ints.pop_back();
+            break;
+        case EListStorage::Double:
+            _doubles.pop_back();
+            break;
+        case EListStorage::Boolean:
+            _bools.pop_back();
+            break;
+        case EListStorage::Objects:
+            _vec.pop_back();
+            break;
+        }
 
         return last;
     }
@@ -146,11 +549,13 @@ namespace spp::runtime
         {
             const auto self = cast<DynamicObject>(this->GetRef());
             std::vector<std::shared_ptr<Object>> mapped;
-            for (auto i = 0; i < _vec.size(); i++)
+            mapped.reserve(GetSize());
+            for (auto i = 0; i < GetSize(); i++)
             {
-                mapped.push_back(fn->Call(self,_vec.at(i), makeNumber(i),self));
+                mapped.push_back(resolveReference(fn->Call(self,GetItem(i), makeNumber(i),self)));
             }
 
+            // Packs the result when the callback returned numbers or booleans only
             return makeList(mapped);
         }
 
@@ -168,9 +573,9 @@ namespace spp::runtime
         if (const auto fn = cast<Function>(arg))
         {
             const auto self = cast<DynamicObject>(this->GetRef());
-            for (auto i = 0; i < _vec.size(); i++)
+            for (auto i = 0; i < GetSize(); i++)
             {
-                fn->Call(self,_vec.at(i), makeNumber(i),self);
+                fn->Call(self,GetItem(i), makeNumber(i),self);
             }
         }
 
@@ -188,12 +593,59 @@ namespace spp::runtime
         if (const auto fn = cast<Function>(arg))
         {
             const auto self = cast<DynamicObject>(this->GetRef());
+            const auto keep = [&](size_t i,const std::shared_ptr<Object>& item)
+            {
+                return fn->Call(self,item, makeNumber(i),self)->ToBoolean(fnScope);
+            };
+
+            // Packed lists copy the raw values that pass instead of boxing them. The callback may modify or unpack the
+            // list, so the values are read from a copy taken before the first call
+            const auto filterPacked = [&]<typename T>(const std::vector<T> items)
+            {
+                std::vector<T> filtered;
+                for (size_t i = 0; i < items.size(); i++)
+                {
+                    const T value = items[i];
+                    const auto item = [value]() -> std::shared_ptr<Object>
+                    {
+                        if constexpr (std::is_same_v<T,bool>)
+                        {
+                            return makeBoolean(value);
+                        }
+                        else
+                        {
+                            return makeNumber(value);
+                        }
+                    }();
+
+                    if (keep(i,item))
+                    {
+                        filtered.push_back(value);
+                    }
+                }
+
+                return makeList(std::move(filtered));
+            };
+            
+            switch (_storage)
+            {
+            case EListStorage::Int64:
+                return filterPacked(_ints);
+            case EListStorage::Double:
+                return filterPacked(_doubles);
+            case EListStorage::Boolean:
+                return filterPacked(_bools);
+            case EListStorage::Objects:
+                break;
+            }
+            
             std::vector<std::shared_ptr<Object>> filtered;
             for (auto i = 0; i < _vec.size(); i++)
             {
-                if (fn->Call(self,_vec.at(i), makeNumber(i),self)->ToBoolean(fnScope))
+                const auto item = _vec.at(i);
+                if (keep(i,item))
                 {
-                    filtered.push_back(_vec.at(i));
+                    filtered.push_back(item);
                 }
             }
 
@@ -214,11 +666,11 @@ namespace spp::runtime
         if (const auto fn = cast<Function>(arg))
         {
             const auto self = cast<DynamicObject>(this->GetRef());
-            for (auto i = 0; i < _vec.size(); i++)
+            for (auto i = 0; i < GetSize(); i++)
             {
-                if (fn->Call(self,_vec.at(i), makeNumber(i),self)->ToBoolean(fnScope))
+                if (fn->Call(self,GetItem(i), makeNumber(i),self)->ToBoolean(fnScope))
                 {
-                    return _vec.at(i);
+                    return GetItem(i);
                 }
             }
         }
@@ -237,9 +689,9 @@ namespace spp::runtime
         if (const auto fn = cast<Function>(arg))
         {
             const auto self = cast<DynamicObject>(this->GetRef());
-            for (auto i = 0; i < _vec.size(); i++)
+            for (auto i = 0; i < GetSize(); i++)
             {
-                if (fn->Call(self,_vec.at(i), makeNumber(i),self)->ToBoolean(fnScope))
+                if (fn->Call(self,GetItem(i), makeNumber(i),self)->ToBoolean(fnScope))
                 {
                     return makeNumber(i);
                 }
@@ -249,72 +701,251 @@ namespace spp::runtime
         return makeNull();
     }
 
-    std::shared_ptr<Object> List::Sort(const std::shared_ptr<FunctionScope>& fnScope)
+    template <typename T>
+    void List::ApplyOrder(std::vector<T>& items, const std::vector<size_t>& order, const std::shared_ptr<ScopeLike>& scope)
     {
+        // A comparator that runs script code may have resized the list, the permutation no longer fits it
+        if(items.size() != order.size())
+        {
+            throw makeException(scope,"List was modified during sort");
+        }
 
-        const auto args = fnScope->GetNamedArgs();
+        std::vector<T> sorted;
+        sorted.reserve(items.size());
+        for(const auto i : order)
+        {
+            sorted.push_back(items[i]);
+        }
+
+        items = std::move(sorted);
+    }
 
-        std::function<int(const void*,const void*)> sortFn;
-        if (const auto fn = args.empty() ? std::shared_ptr<Function>(nullptr) : cast<Function>(resolveReference(fnScope->GetArgument(0))))
+    void List::MergeSort(std::vector<size_t>& order, const std::function<bool(size_t, size_t)>& less)
+    {
+        // Bottom up merge sort. Every index comes from the loop bounds, never from what less returned, so a
+        // comparator that is not a strict weak ordering gives some order instead of reading out of bounds
+        std::vector<size_t> buffer(order.size());
+        for(size_t width = 1; width < order.size(); width *= 2)
         {
-            const auto self = cast<DynamicObject>(this->GetRef());
-            std::ranges::sort(_vec,[fn,self] (const std::shared_ptr<Object>& a,const std::shared_ptr<Object>& b)
+            for(size_t begin = 0; begin < order.size(); begin += width * 2)
             {
-                if(const auto r = fn->Call(self,a,b); r->GetType() == EObjectType::Number)
+                const auto middle = std::min(begin + width,order.size());
+                const auto end = std::min(begin + width * 2,order.size());
+                auto left = begin;
+                auto right = middle;
+                auto out = begin;
+                while(left < middle && right < end)
                 {
-                    const int i = cast<Number,Object>(r)->GetValueAs<int>();
-                    return i;
+                    buffer[out++] = less(order[right],order[left]) ? order[right++] : order[left++];
                 }
-                
-                return 0;
-            });
+
+                while(left < middle)
+                {
+                    buffer[out++] = order[left++];
+                }
+
+                while(right < end)
+                {
+                    buffer[out++] = order[right++];
+                }
+            }
+
+            order.swap(buffer);
+        }
+    }
+
+    void List::SortWith(const std::function<bool(size_t, size_t)>& less, bool stable, bool trusted, const std::shared_ptr<ScopeLike>& scope)
+    {
+        std::vector<size_t> order(GetSize());
+        std::iota(order.begin(),order.end(),0);
+
+        if(!trusted)
+        {
+            MergeSort(order,less);
+        }
+        else if(stable)
+        {
+            std::ranges::stable_sort(order,less);
         }
         else
         {
-            const auto self = cast<DynamicObject>(this->GetRef());
-            
-            std::ranges::sort(_vec,[fnScope] (const std::shared_ptr<Object>& a,const std::shared_ptr<Object>& b)
+            std::ranges::sort(order,less);
+        }
+
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            ApplyOrder(_ints,order,scope);
+            break;
+        case EListStorage::Double:
+            ApplyOrder(_doubles,order,scope);
+            break;
+        case EListStorage::Boolean:
+            ApplyOrder(_bools,order,scope);
+            break;
+        case EListStorage::Objects:
+            ApplyOrder(_vec,order,scope);
+            break;
+        }
+    }
+
+    void List::SortByKeys(const std::vector<std::shared_ptr<Object>>& keys, bool stable, const std::shared_ptr<ScopeLike>& scope)
+    {
+        // Keys of a single kind are compared natively instead of through Less
+        const auto allOf = [&keys](EObjectType type)
+        {
+            return std::ranges::all_of(keys,[type](const std::shared_ptr<Object>& key){ return key->GetType() == type; });
+        };
+
+        if(allOf(EObjectType::Number))
+        {
+            const auto isInteger = std::ranges::all_of(keys,[](const std::shared_ptr<Object>& key)
             {
+                const auto type = castStatic<Number>(key)->GetNumberType();
+                return type == ENumberType::Int || type == ENumberType::Int64;
+            });
 
-                if(a->Less(b, fnScope))
+            if(isInteger)
+            {
+                std::vector<int64_t> values;
+                values.reserve(keys.size());
+                for(auto &key : keys)
                 {
-                    return -1;
+                    values.push_back(castStatic<Number>(key)->GetValueAs<int64_t>());
                 }
+                
+                SortWith([&values](size_t a,size_t b){ return values[a] < values[b]; },stable,true,scope);
+                return;
+            }
 
-                if(a->Greater(b, fnScope))
-                {
-                    return 1;
-                }
+            std::vector<double> values;
+            values.reserve(keys.size());
+            for(auto &key : keys)
+            {
+                values.push_back(castStatic<Number>(key)->GetValueAs<double>());
+            }
+            
+            SortWith([&values](size_t a,size_t b){ return doubleLess(values[a],values[b]); },stable,true,scope);
+            return;
+        }
 
-                return 0;
-            });
+        if(allOf(EObjectType::String))
+        {
+            std::vector<std::string_view> values;
+            values.reserve(keys.size());
+            for(auto &key : keys)
+            {
+                values.push_back(castStatic<String>(key)->GetView());
+            }
+            
+            SortWith([&values](size_t a,size_t b){ return values[a] < values[b]; },stable,true,scope);
+            return;
+        }
+
+        SortWith([&keys,&scope](size_t a,size_t b){ return keys[a]->Less(keys[b],scope); },stable,false,scope);
+    }
+
+    std::shared_ptr<Object> List::Sort(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto stable = findOptionalArg(fnScope,"stable")->ToBoolean(fnScope);
+        const auto fn = cast<Function>(findOptionalArg(fnScope,"callback"));
+
+        if(!fn)
+        {
+            // Packed values have no identity, so a plain sort is already stable
+            switch (_storage)
+            {
+            case EListStorage::Int64:
+                std::ranges::sort(_ints);
+                return this->GetRef();
+            case EListStorage::Double:
+                std::ranges::sort(_doubles,doubleLess);
+                return this->GetRef();
+            case EListStorage::Boolean:
+                std::sort(_bools.begin(),_bools.end());
+                return this->GetRef();
+            case EListStorage::Objects:
+                break;
+            }
+
+            SortByKeys(_vec,stable,fnScope);
+            return this->GetRef();
+        }
+
+        // The callback works like a C comparator, a negative number means a comes before b. Booleans are read as a < b.
+        std::vector<std::shared_ptr<Object>> items;
+        items.reserve(GetSize());
+        for(size_t i = 0; i < GetSize(); i++)
+        {
+            items.push_back(GetItem(i));
         }
         
+        const auto self = cast<DynamicObject>(this->GetRef());
+        SortWith([&](size_t a,size_t b)
+        {
+            const auto result = resolveReference(fn->Call(self,items[a],items[b]));
+            if(result->GetType() == EObjectType::Number)
+            {
+                return castStatic<Number>(result)->GetValueAs<double>() < 0;
+            }
+
+            return result->ToBoolean(fnScope);
+        },stable,false,fnScope);
+        
         return this->GetRef();
     }
 
-    std::shared_ptr<ListPrototype> List::Prototype = makeObject<ListPrototype>();
-
-    std::shared_ptr<Object> List::Size(const std::shared_ptr<FunctionScope>& fnScope)
+    std::shared_ptr<Object> List::SortBy(const std::shared_ptr<FunctionScope>& fnScope)
     {
-        return makeNumber(_vec.size());
+        const auto stable = findOptionalArg(fnScope,"stable")->ToBoolean(fnScope);
+        const auto fn = cast<Function>(findOptionalArg(fnScope,"key"));
+        if(!fn)
+        {
+            throw makeException(fnScope,"No key function passed to sortBy");
+        }
+
+        // Each key is computed once up front rather than on every comparison
+        const auto self = cast<DynamicObject>(this->GetRef());
+        std::vector<std::shared_ptr<Object>> keys;
+        keys.reserve(GetSize());
+        for(size_t i = 0; i < GetSize(); i++)
+        {
+            keys.push_back(resolveReference(fn->Call(self,GetItem(i),makeNumber(static_cast<int64_t>(i)),self)));
+        }
+
+        if(keys.size() != GetSize())
+        {
+            throw makeException(fnScope,"List was modified during sortBy");
+        }
+
+        SortByKeys(keys,stable,fnScope);
+        return this->GetRef();
     }
 
-    std::shared_ptr<Object> List::Join(const std::shared_ptr<FunctionScope>& fnScope)
+    std::shared_ptr<ListPrototype> List::Prototype = makeObject<ListPrototype>();
+
+    std::shared_ptr<Object> List::Join(const std::shared_ptr<Object>& delimiter,NativeCallContext& ctx) const
     {
         std::string result;
 
-        auto delimiter = resolveReference(fnScope->Find("delimiter"));
-        if(delimiter->Equal(makeNull(), fnScope))
+        const auto& scope = ctx.GetCallScope();
+        const std::string delimiterStr = delimiter->GetType() == EObjectType::Null ? "" : delimiter->ToString(scope);
+
+        switch (_storage)
         {
-            delimiter = makeString("");
+        case EListStorage::Int64:
+            return makeString(joinPacked(_ints,delimiterStr));
+        case EListStorage::Double:
+            return makeString(joinPacked(_doubles,delimiterStr));
+        case EListStorage::Boolean:
+            return makeString(joinPacked(_bools,delimiterStr));
+        case EListStorage::Objects:
+            break;
         }
 
-        const std::string delimiterStr = delimiter->ToString(fnScope);
-
         for(auto i = 0; i < _vec.size(); i++)
         {
-            result += _vec.at(i)->ToString(fnScope);
+            result += _vec.at(i)->ToString(scope);
             if(i != _vec.size() - 1)
             {
                 result += delimiterStr;
@@ -324,24 +955,367 @@ namespace spp::runtime
         return makeString(result);
     }
 
-    std::shared_ptr<Object> List::Reverse(const std::shared_ptr<FunctionScope>& fnScope)
+    std::shared_ptr<Object> List::Reverse() const
     {
+        const auto reversed = []<typename T>(const std::vector<T>& items)
+        {
+            return makeList(std::vector<T>(items.rbegin(),items.rend()));
+        };
+        
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            return reversed(_ints);
+        case EListStorage::Double:
+            return reversed(_doubles);
+        case EListStorage::Boolean:
+            return reversed(_bools);
+        case EListStorage::Objects:
+            break;
+        }
+        
         std::vector<std::shared_ptr<Object>> vec = _vec;
         std::ranges::reverse(vec);
         return makeList(vec);
     }
 
+    std::shared_ptr<Object> List::Sum(NativeCallContext& ctx) const
+    {
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            if(int64_t result; numeric::sum(_ints,result))
+            {
+                return makeNumber(result);
+            }
+            
+            return makeNumber(numeric::sum(GetDoubles()));
+        case EListStorage::Double:
+            return makeNumber(numeric::sum(_doubles));
+        default:
+            break;
+        }
+
+        if(GetSize() == 0)
+        {
+            return makeNumber(static_cast<int64_t>(0));
+        }
+        
+        auto result = GetItem(0);
+        for(size_t i = 1; i < GetSize(); i++)
+        {
+            result = result->Add(GetItem(i),ctx.GetCallScope());
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<Object> List::Min(NativeCallContext& ctx) const
+    {
+        if(GetSize() == 0)
+        {
+            throw makeException(ctx.GetScope(),"Attempted to take the min of an empty list");
+        }
+        
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            return makeNumber(numeric::min(_ints));
+        case EListStorage::Double:
+            return makeNumber(numeric::min(_doubles));
+        default:
+            break;
+        }
+        
+        auto result = GetItem(0);
+        for(size_t i = 1; i < GetSize(); i++)
+        {
+            if(const auto item = GetItem(i); item->Less(result,ctx.GetCallScope()))
+            {
+                result = item;
+            }
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<Object> List::Max(NativeCallContext& ctx) const
+    {
+        if(GetSize() == 0)
+        {
+            throw makeException(ctx.GetScope(),"Attempted to take the max of an empty list");
+        }
+        
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            return makeNumber(numeric::max(_ints));
+        case EListStorage::Double:
+            return makeNumber(numeric::max(_doubles));
+        default:
+            break;
+        }
+        
+        auto result = GetItem(0);
+        for(size_t i = 1; i < GetSize(); i++)
+        {
+            if(const auto item = GetItem(i); item->Greater(result,ctx.GetCallScope()))
+            {
+                result = item;
+            }
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<Object> List::Mean(NativeCallContext& ctx) const
+    {
+        if(GetSize() == 0)
+        {
+            throw makeException(ctx.GetScope(),"Attempted to take the mean of an empty list");
+        }
+
+        const auto size = static_cast<double>(GetSize());
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            if(int64_t result; numeric::sum(_ints,result))
+            {
+                return makeNumber(static_cast<double>(result) / size);
+            }
+
+            return makeNumber(numeric::sum(GetDoubles()) / size);
+        case EListStorage::Double:
+            return makeNumber(numeric::sum(_doubles) / size);
+        default:
+            break;
+        }
+
+        // Packed booleans have no boxed items in _vec, GetItem boxes them so they get the same error as any other list
+        double total = 0;
+        for(size_t i = 0; i < GetSize(); i++)
+        {
+            const auto item = GetItem(i);
+            if(item->GetType() != EObjectType::Number)
+            {
+                throw makeException(ctx.GetScope(),"Attempted to take the mean of a list that has non numbers");
+            }
+            
+            total += castStatic<Number>(item)->GetValueAs<double>();
+        }
+
+        return makeNumber(total / size);
+    }
+
+    std::shared_ptr<Object> List::Dot(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto other = FindListArg(fnScope,"other");
+        if(int64_t result; _storage == EListStorage::Int64 && other->_storage == EListStorage::Int64 && numeric::dot(_ints,other->_ints,result))
+        {
+            return makeNumber(result);
+        }
+
+        if(IsPackedNumeric() && other->IsPackedNumeric())
+        {
+            return makeNumber(numeric::dot(GetDoubles(),other->GetDoubles()));
+        }
+
+        std::shared_ptr<Object> result = makeNumber(static_cast<int64_t>(0));
+        for(size_t i = 0; i < GetSize(); i++)
+        {
+            result = result->Add(GetItem(i)->Multiply(other->GetItem(i),fnScope),fnScope);
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<Object> List::Scale(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto factor = resolveReference(fnScope->Find("factor"));
+        if(factor->GetType() != EObjectType::Number)
+        {
+            throw makeException(fnScope,"factor must be a number");
+        }
+
+        const auto number = castStatic<Number>(factor);
+        const auto isIntegerFactor = number->GetNumberType() == ENumberType::Int || number->GetNumberType() == ENumberType::Int64;
+        if(_storage == EListStorage::Int64 && isIntegerFactor)
+        {
+            if(std::vector<int64_t> result(_ints.size()); numeric::scale(_ints,number->GetValueAs<int64_t>(),result))
+            {
+                return makeList(std::move(result));
+            }
+        }
+
+        if(IsPackedNumeric())
+        {
+            const auto items = GetDoubles();
+            std::vector<double> result(items.size());
+            numeric::scale(items,number->GetValueAs<double>(),result);
+            return makeList(std::move(result));
+        }
+
+        std::vector<std::shared_ptr<Object>> result;
+        result.reserve(GetSize());
+        for(size_t i = 0; i < GetSize(); i++)
+        {
+            result.push_back(GetItem(i)->Multiply(factor,fnScope));
+        }
+
+        return makeList(result);
+    }
+
+    std::shared_ptr<Object> List::AddList(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto other = FindListArg(fnScope,"other");
+        if(_storage == EListStorage::Int64 && other->_storage == EListStorage::Int64)
+        {
+            if(std::vector<int64_t> result(_ints.size()); numeric::add(_ints,other->_ints,result))
+            {
+                return makeList(std::move(result));
+            }
+        }
+
+        if(IsPackedNumeric() && other->IsPackedNumeric())
+        {
+            const auto a = GetDoubles();
+            const auto b = other->GetDoubles();
+            std::vector<double> result(a.size());
+            numeric::add(a,b,result);
+            return makeList(std::move(result));
+        }
+
+        std::vector<std::shared_ptr<Object>> result;
+        result.reserve(GetSize());
+        for(size_t i = 0; i < GetSize(); i++)
+        {
+            result.push_back(GetItem(i)->Add(other->GetItem(i),fnScope));
+        }
+
+        return makeList(result);
+    }
+
+    // Callbacks only get the item and its index so they have no way to modify the list while it is shared
+    std::shared_ptr<Object> List::ParallelMap(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto fn = findParallelCallback(fnScope,"parallelMap");
+        const auto self = cast<DynamicObject>(this->GetRef());
+        std::vector<std::shared_ptr<Object>> mapped(GetSize());
+        WorkerPool::Get().ParallelFor(mapped.size(),parallelGrain(mapped.size()),[&](size_t begin,size_t end)
+        {
+            for (auto i = begin; i < end; i++)
+            {
+                mapped[i] = resolveReference(fn->Call(self,GetItem(i),makeNumber(static_cast<int64_t>(i))));
+            }
+        });
+
+        return makeList(mapped);
+    }
+
+    std::shared_ptr<Object> List::ParallelFilter(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto fn = findParallelCallback(fnScope,"parallelFilter");
+        const auto self = cast<DynamicObject>(this->GetRef());
+        const auto size = GetSize();
+        std::vector<char> keep(size);
+        WorkerPool::Get().ParallelFor(size,parallelGrain(size),[&](size_t begin,size_t end)
+        {
+            for (auto i = begin; i < end; i++)
+            {
+                keep[i] = fn->Call(self,GetItem(i),makeNumber(static_cast<int64_t>(i)))->ToBoolean(fnScope);
+            }
+        });
+
+        const auto compact = [&]<typename T>(const std::vector<T>& items)
+        {
+            std::vector<T> filtered;
+            for (size_t i = 0; i < size; i++)
+            {
+                if (keep[i])
+                {
+                    filtered.push_back(items[i]);
+                }
+            }
+
+            return makeList(std::move(filtered));
+        };
+
+        switch (_storage)
+        {
+        case EListStorage::Int64:
+            return compact(_ints);
+        case EListStorage::Double:
+            return compact(_doubles);
+        case EListStorage::Boolean:
+            return compact(_bools);
+        case EListStorage::Objects:
+            break;
+        }
+
+        std::vector<std::shared_ptr<Object>> filtered;
+        for (size_t i = 0; i < size; i++)
+        {
+            if (keep[i])
+            {
+                filtered.push_back(_vec[i]);
+            }
+        }
+
+        return makeList(filtered);
+    }
+
+    std::shared_ptr<Object> List::ParallelForEach(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto fn = findParallelCallback(fnScope,"parallelForEach");
+        const auto self = cast<DynamicObject>(this->GetRef());
+        WorkerPool::Get().ParallelFor(GetSize(),parallelGrain(GetSize()),[&](size_t begin,size_t end)
+        {
+            for (auto i = begin; i < end; i++)
+            {
+                fn->Call(self,GetItem(i),makeNumber(static_cast<int64_t>(i)));
+            }
+        });
+
+        return makeNull();
+    }
+
+    std::shared_ptr<Object> List::Iter(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeIterator(this->GetRef(),fnScope);
+    }
+
     std::vector<std::shared_ptr<Object>>& List::GetNative()
     {
+        Unpack();
         return _vec;
     }
 
     size_t List::GetHashCode(const std::shared_ptr<ScopeLike>& scope)
     {
+        // Items hash the way dictionary keys do so a packed list and a boxed list with equal items hash alike
         auto result = DynamicObject::GetHashCode(scope);
-        for (auto &object : _vec)
+        switch (_storage)
         {
-            result = hashCombine(result,object->GetHashCode());
+        case EListStorage::Int64:
+            for (auto &item : _ints)
+            {
+                result = hashCombine(result,ObjectMap::HashInteger(item));
+            }
+            return result;
+        case EListStorage::Double:
+            for (auto &item : _doubles)
+            {
+                result = hashCombine(result,ObjectMap::HashFloating(item));
+            }
+            return result;
+        case EListStorage::Boolean:
+        case EListStorage::Objects:
+            break;
+        }
+        
+        for (size_t i = 0; i < GetSize(); i++)
+        {
+            result = hashCombine(result,ObjectMap::Hash(GetItem(i)));
         }
         return result;
     }
@@ -350,6 +1324,12 @@ namespace spp::runtime
     {
     }
 
+    void ListPrototype::Init()
+    {
+        Prototype::Init();
+        AddNativeMemberFunction("range",this,vectorOf<std::string>("start","end","step"),&ListPrototype::Range);
+    }
+
     std::string ListPrototype::ToString(const std::shared_ptr<ScopeLike>& scope) const
     {
         return "<Prototype : List>";
@@ -357,7 +1337,13 @@ namespace spp::runtime
 
     std::shared_ptr<DynamicObject> ListPrototype::CreateInstance(std::shared_ptr<FunctionScope>& scope)
     {
-        return makeList(scope->GetPositionalArgs());
+        std::vector<std::shared_ptr<Object>> items;
+        for(auto &arg : scope->GetPositionalArgs())
+        {
+            items.push_back(resolveReference(arg));
+        }
+        
+        return makeList(items);
     }
 
     std::string ListPrototype::GetName() const
@@ -365,6 +1351,60 @@ namespace spp::runtime
         return "List";
     }
 
+    std::shared_ptr<Object> ListPrototype::Range(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto hasArg = [&fnScope](const std::string& id)
+        {
+            return findOptionalArg(fnScope,id)->GetType() != EObjectType::Null;
+        };
+        
+        const auto getInteger = [&fnScope](const std::string& id,int64_t fallback)
+        {
+            const auto arg = findOptionalArg(fnScope,id);
+            if(arg->GetType() == EObjectType::Null)
+            {
+                return fallback;
+            }
+
+            if(arg->GetType() != EObjectType::Number)
+            {
+                throw makeException(fnScope,id + " must be a number");
+            }
+
+            return castStatic<Number>(arg)->GetValueAs<int64_t>();
+        };
+
+        auto start = getInteger("start",0);
+        auto end = getInteger("end",start);
+        const auto step = getInteger("step",1);
+
+        // range(n) counts from 0 to n
+        if(!hasArg("end"))
+        {
+            start = 0;
+        }
+
+        if(step == 0)
+        {
+            throw makeException(fnScope,"step must not be 0");
+        }
+
+        std::vector<int64_t> result;
+        if((step > 0 && start < end) || (step < 0 && start > end))
+        {
+            const auto distance = step > 0 ? end - start : start - end;
+            const auto stepSize = step > 0 ? step : -step;
+            result.reserve(static_cast<size_t>((distance + stepSize - 1) / stepSize));
+        }
+        
+        for(auto i = start; step > 0 ? i < end : i > end; i += step)
+        {
+            result.push_back(i);
+        }
+
+        return makeList(std::move(result));
+    }
+
     std::shared_ptr<List> makeList()
     {
         return makeList(std::vector<std::shared_ptr<Object>>{});
@@ -374,9 +1414,24 @@ namespace spp::runtime
     {
         return  makeObject<List>(items);
     }
+
+    std::shared_ptr<List> makeList(std::vector<int64_t>&& items)
+    {
+        return makeObject<List>(std::move(items));
+    }
+
+    std::shared_ptr<List> makeList(std::vector<double>&& items)
+    {
+        return makeObject<List>(std::move(items));
+    }
+
+    std::shared_ptr<List> makeList(std::vector<bool>&& items)
+    {
+        return makeObject<List>(std::move(items));
+    }
     
     std::shared_ptr<ListItemReference> makeListReference(const List* list, uint32_t idx)
     {
-        return makeObject<ListItemReference>(idx,cast<DynamicObject>(list->GetRef()), const_cast<List*>(list)->GetNative()[idx]);
+        return makeObject<ListItemReference>(idx,cast<DynamicObject>(list->GetRef()), list->GetItem(idx));
     }
 }
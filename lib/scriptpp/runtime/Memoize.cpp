@@ -0,0 +1,170 @@
+#include "scriptpp/runtime/Memoize.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+#include "scriptpp/runtime/eval.hpp"
+#include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/ObjectMap.hpp"
+#include "scriptpp/runtime/String.hpp"
+#include "scriptpp/runtime/Tuple.hpp"
+
+namespace spp::runtime
+{
+    size_t MemoizedFunction::KeyHash::operator()(const std::shared_ptr<Object>& key) const
+    {
+        return ObjectMap::Hash(key);
+    }
+
+    bool MemoizedFunction::KeyEqual::operator()(const std::shared_ptr<Object>& a, const std::shared_ptr<Object>& b) const
+    {
+        return ObjectMap::KeysEqual(a,b);
+    }
+
+    std::shared_ptr<Object> MemoizedFunction::MakeKey(const std::vector<std::shared_ptr<Object>>& positionalArgs,
+        const NamedArguments& namedArgs)
+    {
+        const auto mutableArg = [](const std::shared_ptr<Object>& arg)
+        {
+            return !Tuple::IsImmutable(arg);
+        };
+
+        if(std::ranges::any_of(positionalArgs,mutableArg) || std::ranges::any_of(namedArgs | std::views::values,mutableArg))
+        {
+            return {};
+        }
+
+        // A lone tuple argument is still wrapped so f((1,2)) and f(1,2) get different keys
+        if(positionalArgs.size() == 1 && namedArgs.empty() && !dynamic_cast<const Tuple*>(positionalArgs[0].get()))
+        {
+            return positionalArgs[0];
+        }
+
+        std::vector<std::shared_ptr<Object>> items{};
+        items.reserve(positionalArgs.size() + namedArgs.size() * 2);
+        items.insert(items.end(),positionalArgs.begin(),positionalArgs.end());
+        for (auto &[id,arg] : namedArgs)
+        {
+            items.push_back(makeInternedString(id));
+            items.push_back(arg);
+        }
+
+        return makeTuple(std::move(items));
+    }
+
+    MemoizedFunction::MemoizedFunction(const std::shared_ptr<Function>& fn, size_t maxSize) : Function(fn->GetDeclarationScope(),fn->GetName(),fn->GetParameters()), _fn(fn), _maxSize(maxSize)
+    {
+    }
+
+    std::shared_ptr<Object> MemoizedFunction::HandleCall(std::shared_ptr<FunctionScope>& scope)
+    {
+        // Results are cached by value so arguments are passed resolved
+        const auto args = scope->GetPositionalArgs();
+        std::vector<std::shared_ptr<Object>> positionalArgs{};
+        positionalArgs.reserve(args.size());
+        for (auto &arg : args)
+        {
+            positionalArgs.push_back(resolveReference(arg));
+        }
+
+        NamedArguments namedArgs{};
+        for (auto &[id,arg] : scope->GetNamedArgs())
+        {
+            namedArgs.emplace_back(id,resolveReference(arg));
+        }
+
+        std::ranges::sort(namedArgs,[](const auto& a,const auto& b)
+        {
+            return a.first < b.first;
+        });
+
+        const auto key = MakeKey(positionalArgs,namedArgs);
+        if(!key)
+        {
+            return _fn->Call(std::move(positionalArgs),std::move(namedArgs),scope->GetCallerScope());
+        }
+
+        {
+            std::lock_guard lock(_mutex);
+            if(const auto it = _index.find(key); it != _index.end())
+            {
+                _entries.splice(_entries.begin(),_entries,it->second);
+                return it->second->second;
+            }
+        }
+
+        // The lock is not held during the call, recursive functions come back through here
+        auto result = resolveReference(_fn->Call(std::move(positionalArgs),std::move(namedArgs),scope->GetCallerScope()));
+
+        std::lock_guard lock(_mutex);
+        if(const auto it = _index.find(key); it != _index.end())
+        {
+            return it->second->second;
+        }
+
+        _entries.emplace_front(key,result);
+        _index.emplace(key,_entries.begin());
+
+        if(_maxSize != 0 && _entries.size() > _maxSize)
+        {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<Function> MemoizedFunction::Clone()
+    {
+        auto result = makeMemoizedFunction(_fn->Clone(),_maxSize);
+        result->SetOwner(GetOwner());
+        return result;
+    }
+
+    const std::shared_ptr<Function>& MemoizedFunction::GetWrapped() const
+    {
+        return _fn;
+    }
+
+    size_t MemoizedFunction::GetCacheSize()
+    {
+        std::lock_guard lock(_mutex);
+        return _entries.size();
+    }
+
+    void MemoizedFunction::ClearCache()
+    {
+        std::lock_guard lock(_mutex);
+        _index.clear();
+        _entries.clear();
+    }
+
+    std::shared_ptr<MemoizedFunction> makeMemoizedFunction(const std::shared_ptr<Function>& fn, size_t maxSize)
+    {
+        return makeObject<MemoizedFunction>(fn,maxSize);
+    }
+
+    std::shared_ptr<Object> memoize(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto [fn,callScope] = resolveCallable(resolveReference(fnScope->GetArgument(0)),fnScope);
+        if(!fn)
+        {
+            throw makeException(fnScope,"memoize expects a function");
+        }
+
+        size_t maxSize = 0;
+        if(fnScope->Has("maxSize",false))
+        {
+            const auto arg = resolveReference(fnScope->FindArgument("maxSize"));
+            if(arg->GetType() != EObjectType::Number || castStatic<Number>(arg)->GetValueAs<int64_t>() < 0)
+            {
+                throw makeException(fnScope,"maxSize must be a non-negative number");
+            }
+
+            maxSize = static_cast<size_t>(castStatic<Number>(arg)->GetValueAs<int64_t>());
+        }
+
+        return makeMemoizedFunction(fn,maxSize);
+    }
+}
@@ -0,0 +1,204 @@
+#include "scriptpp/runtime/NativeCall.hpp"
+
+#include "scriptpp/runtime/Boolean.hpp"
+#include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Null.hpp"
+#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/String.hpp"
+
+namespace spp::runtime
+{
+    NativeCallContext::NativeCallContext(FastNativeFunction& fn, NativeArgs args, const NamedArguments& namedArgs,
+        const std::shared_ptr<ScopeLike>& callScope) : _fn(fn), _args(args), _namedArgs(namedArgs), _callScope(callScope)
+    {
+    }
+
+    NativeCallContext::~NativeCallContext()
+    {
+        releaseFunctionScope(std::move(_frame));
+    }
+
+    std::shared_ptr<Object> NativeCallContext::GetSelf() const
+    {
+        return _fn.GetSelf();
+    }
+
+    const std::shared_ptr<ScopeLike>& NativeCallContext::GetCallScope() const
+    {
+        return _callScope;
+    }
+
+    const NamedArguments& NativeCallContext::GetNamedArgs() const
+    {
+        return _namedArgs;
+    }
+
+    const std::shared_ptr<FunctionScope>& NativeCallContext::GetScope()
+    {
+        if(!_frame)
+        {
+            _frame = makeFunctionScope(castStatic<Function>(_fn.GetRef()),_callScope ? _callScope : makeCallScope(),_fn.GetDeclarationScope(),_fn.GetLayout(),
+                std::vector(_args.begin(),_args.end()),NamedArguments(_namedArgs));
+        }
+
+        return _frame;
+    }
+
+    FastNativeFunction::FastNativeFunction(const std::shared_ptr<ScopeLike>& scope, const std::string& name,
+        const std::vector<std::string>& params, NativeFunctionPointer func) : Function(scope,name,params), _func(func)
+    {
+    }
+
+    FastNativeFunction::FastNativeFunction(const std::shared_ptr<ScopeLike>& scope, const std::string& name,
+        const std::vector<std::shared_ptr<frontend::ParameterNode>>& params, const std::shared_ptr<const ParameterLayout>& layout,
+        NativeFunctionPointer func) : Function(scope,name,params,layout), _func(func)
+    {
+    }
+
+    std::shared_ptr<Object> FastNativeFunction::Call(std::vector<std::shared_ptr<Object>> positionalArgs,
+        NamedArguments namedArgs, const std::shared_ptr<ScopeLike>& callScope)
+    {
+        for (auto &arg : positionalArgs)
+        {
+            arg = resolveReference(arg);
+        }
+
+        for (auto &[id,arg] : namedArgs)
+        {
+            arg = resolveReference(arg);
+        }
+
+        // Parameters that were not passed positionally are filled from the named arguments, or null
+        if(const auto& names = GetLayout()->names; positionalArgs.size() < names.size())
+        {
+            const auto positionalCount = positionalArgs.size();
+            positionalArgs.resize(names.size());
+            for (auto &[id,arg] : namedArgs)
+            {
+                if(const auto slot = GetLayout()->FindSlot(id); slot >= static_cast<int32_t>(positionalCount))
+                {
+                    positionalArgs[slot] = arg;
+                }
+            }
+
+            for (auto &arg : positionalArgs)
+            {
+                if(!arg)
+                {
+                    arg = makeNull();
+                }
+            }
+        }
+
+        NativeCallContext ctx(*this,positionalArgs,namedArgs,callScope);
+        try
+        {
+            const auto result = _func(positionalArgs,ctx);
+            return result ? result : makeNull();
+        }
+        catch (ExceptionContainer&)
+        {
+            throw;
+        }
+        catch (std::exception& e)
+        {
+            throw makeException(ctx.GetScope(),e.what());
+        }
+    }
+
+    std::shared_ptr<Object> FastNativeFunction::HandleCall(std::shared_ptr<FunctionScope>& scope)
+    {
+        // Only reached when a frame was already built for the call, e.g. by a tail call
+        const auto args = scope->GetPositionalArgs();
+        return Call(std::vector(args.begin(),args.end()),scope->GetNamedArgs(),scope->GetCallerScope());
+    }
+
+    bool FastNativeFunction::IsCalledThroughFrame() const
+    {
+        return false;
+    }
+
+    std::shared_ptr<Function> FastNativeFunction::Clone()
+    {
+        auto result = makeObject<FastNativeFunction>(GetDeclarationScope(),GetName(),GetParameters(),GetLayout(),_func);
+        result->SetOwner(GetOwner());
+        result->SetSelf(_self);
+        return result;
+    }
+
+    void FastNativeFunction::SetSelf(const std::shared_ptr<Object>& self)
+    {
+        _self = self;
+    }
+
+    std::shared_ptr<Object> FastNativeFunction::GetSelf() const
+    {
+        return _self ? _self : GetOwner();
+    }
+
+    std::shared_ptr<FastNativeFunction> makeFastNativeFunction(const std::shared_ptr<ScopeLike>& scope, const std::string& name,
+        const std::vector<std::string>& params, NativeFunctionPointer func, bool addToScope)
+    {
+        auto fn = makeObject<FastNativeFunction>(scope,name,params,func);
+        if(scope && addToScope)
+        {
+            scope->Assign(name,fn);
+        }
+        return fn;
+    }
+
+    bool nativeToBoolean(const std::shared_ptr<Object>& arg, NativeCallContext& ctx)
+    {
+        return arg && arg->ToBoolean(ctx.GetCallScope());
+    }
+
+    int64_t nativeToInteger(const std::shared_ptr<Object>& arg, NativeCallContext& ctx)
+    {
+        if(!arg || arg->GetType() != EObjectType::Number)
+        {
+            throw makeException(ctx.GetScope(),"Expected a number");
+        }
+
+        return castStatic<Number>(arg)->GetValueAs<int64_t>();
+    }
+
+    double nativeToDouble(const std::shared_ptr<Object>& arg, NativeCallContext& ctx)
+    {
+        if(!arg || arg->GetType() != EObjectType::Number)
+        {
+            throw makeException(ctx.GetScope(),"Expected a number");
+        }
+
+        return castStatic<Number>(arg)->GetValueAs<double>();
+    }
+
+    std::string nativeToString(const std::shared_ptr<Object>& arg, NativeCallContext& ctx)
+    {
+        return arg ? arg->ToString(ctx.GetCallScope()) : std::string{};
+    }
+
+    void throwNativeArgumentError(NativeCallContext& ctx, size_t index)
+    {
+        throw makeException(ctx.GetScope(),"Argument " + std::to_string(index) + " has the wrong type");
+    }
+
+    std::shared_ptr<Object> nativeResult(bool value)
+    {
+        return makeBoolean(value);
+    }
+
+    std::shared_ptr<Object> nativeResult(int64_t value)
+    {
+        return makeNumber(value);
+    }
+
+    std::shared_ptr<Object> nativeResult(double value)
+    {
+        return makeNumber(value);
+    }
+
+    std::shared_ptr<Object> nativeResult(const std::string& value)
+    {
+        return makeString(value);
+    }
+}
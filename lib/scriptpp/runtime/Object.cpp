@@ -75,11 +75,6 @@ namespace spp::runtime
         return std::const_pointer_cast<Object>(shared_from_this());
     }
 
-    ReturnValue::ReturnValue(const std::shared_ptr<Object>& val)
-    {
-        _value = val;
-    }
-
     EObjectType ReturnValue::GetType() const
     {
         return EObjectType::ReturnValue;
@@ -87,12 +82,7 @@ namespace spp::runtime
 
     std::string ReturnValue::ToString(const std::shared_ptr<ScopeLike>& scope) const
     {
-        return "Return Value >> " + _value->ToString(scope);
-    }
-
-    std::shared_ptr<Object> ReturnValue::GetValue() const
-    {
-        return _value;
+        return "Return Value";
     }
 
     FlowControl::FlowControl(const EFlowControlOp& val)
@@ -123,13 +113,16 @@ namespace spp::runtime
         return _op;
     }
 
-    std::shared_ptr<ReturnValue> makeReturnValue(const std::shared_ptr<Object>& val)
+    std::shared_ptr<ReturnValue> makeReturnValue()
     {
-        return makeObject<ReturnValue>(val);
+        static auto universalReturn = makeObject<ReturnValue>();
+        return universalReturn;
     }
 
     std::shared_ptr<FlowControl> makeFlowControl(const FlowControl::EFlowControlOp& val)
     {
-        return makeObject<FlowControl>(val);
+        static auto breakObj = makeObject<FlowControl>(FlowControl::Break);
+        static auto continueObj = makeObject<FlowControl>(FlowControl::Continue);
+        return val == FlowControl::Break ? breakObj : continueObj;
     }
 }
@@ -0,0 +1,369 @@
+#include "scriptpp/runtime/ObjectMap.hpp"
+
+#include <bit>
+#include <cmath>
+
+#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/String.hpp"
+
+namespace spp::runtime
+{
+    namespace
+    {
+        // Spreads the hash so the top bits pick the slot and the low bits make the tag
+        uint64_t mixHash(size_t hash)
+        {
+            return static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+        }
+
+        bool isIntegral(const Number* num)
+        {
+            return num->GetNumberType() == ENumberType::Int || num->GetNumberType() == ENumberType::Int64;
+        }
+
+        int64_t integralValue(const Number* num)
+        {
+            if(num->GetNumberType() == ENumberType::Int)
+            {
+                return static_cast<const TNumber<int>*>(num)->GetValue();
+            }
+
+            return static_cast<const TNumber<int64_t>*>(num)->GetValue();
+        }
+
+        double floatingValue(const Number* num)
+        {
+            switch (num->GetNumberType())
+            {
+            case ENumberType::Int:
+            case ENumberType::Int64:
+                return static_cast<double>(integralValue(num));
+            case ENumberType::Float:
+                return static_cast<const TNumber<float>*>(num)->GetValue();
+            case ENumberType::Double:
+                return static_cast<const TNumber<double>*>(num)->GetValue();
+            }
+
+            return 0;
+        }
+
+        size_t hashNumber(const Number* num)
+        {
+            if(isIntegral(num))
+            {
+                return ObjectMap::HashInteger(integralValue(num));
+            }
+
+            return ObjectMap::HashFloating(floatingValue(num));
+        }
+
+        size_t capacityFor(size_t count)
+        {
+            return std::bit_ceil(std::max<size_t>(count * 2,8));
+        }
+    }
+
+    void ObjectMap::ConstIterator::SkipRemoved()
+    {
+        while(_current != _end && !_current->key)
+        {
+            ++_current;
+        }
+    }
+
+    ObjectMap::ConstIterator::ConstIterator(const Entry* current, const Entry* end) : _current(current), _end(end)
+    {
+        SkipRemoved();
+    }
+
+    const ObjectMap::Entry& ObjectMap::ConstIterator::operator*() const
+    {
+        return *_current;
+    }
+
+    const ObjectMap::Entry* ObjectMap::ConstIterator::operator->() const
+    {
+        return _current;
+    }
+
+    ObjectMap::ConstIterator& ObjectMap::ConstIterator::operator++()
+    {
+        ++_current;
+        SkipRemoved();
+        return *this;
+    }
+
+    bool ObjectMap::ConstIterator::operator==(const ConstIterator& other) const
+    {
+        return _current == other._current;
+    }
+
+    size_t ObjectMap::Size() const
+    {
+        return _size;
+    }
+
+    bool ObjectMap::Empty() const
+    {
+        return _size == 0;
+    }
+
+    void ObjectMap::Reserve(size_t count)
+    {
+        if(count * 4 > _slots.size() * 3)
+        {
+            Rehash(capacityFor(count));
+        }
+
+        _entries.reserve(count);
+    }
+
+    void ObjectMap::Clear()
+    {
+        if(!_entries.empty())
+        {
+            _layoutVersion++;
+        }
+
+        _entries.clear();
+        _slots.clear();
+        _size = 0;
+        _shift = 64;
+    }
+
+    std::shared_ptr<Object>* ObjectMap::Find(const std::shared_ptr<Object>& key)
+    {
+        const auto pos = FindSlot(key,Hash(key));
+        if(pos == _slots.size())
+        {
+            return nullptr;
+        }
+
+        return &_entries[static_cast<uint32_t>(_slots[pos]) - 2].value;
+    }
+
+    const std::shared_ptr<Object>* ObjectMap::Find(const std::shared_ptr<Object>& key) const
+    {
+        return const_cast<ObjectMap*>(this)->Find(key);
+    }
+
+    bool ObjectMap::Contains(const std::shared_ptr<Object>& key) const
+    {
+        return FindSlot(key,Hash(key)) != _slots.size();
+    }
+
+    void ObjectMap::Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& value)
+    {
+        const auto hash = Hash(key);
+        if(const auto pos = FindSlot(key,hash); pos != _slots.size())
+        {
+            _entries[static_cast<uint32_t>(_slots[pos]) - 2].value = value;
+            return;
+        }
+
+        // Removed entries still hold their slot until the next rehash, so they count towards the load. Pinned maps
+        // keep them through the rehash as well
+        if((_entries.size() + 1) * 4 > _slots.size() * 3)
+        {
+            Rehash(capacityFor((_pins == 0 ? _size : _entries.size()) + 1));
+        }
+
+        const auto mixed = mixHash(hash);
+        const auto mask = _slots.size() - 1;
+        auto pos = static_cast<size_t>(mixed >> _shift);
+        while(_slots[pos] != EMPTY_SLOT && _slots[pos] != REMOVED_SLOT)
+        {
+            pos = (pos + 1) & mask;
+        }
+
+        _entries.push_back({hash,key,value});
+        _slots[pos] = (static_cast<uint64_t>(static_cast<uint32_t>(mixed)) << 32) | (_entries.size() + 1);
+        _size++;
+    }
+
+    bool ObjectMap::Erase(const std::shared_ptr<Object>& key)
+    {
+        const auto pos = FindSlot(key,Hash(key));
+        if(pos == _slots.size())
+        {
+            return false;
+        }
+
+        auto& entry = _entries[static_cast<uint32_t>(_slots[pos]) - 2];
+        entry.key.reset();
+        entry.value.reset();
+        _slots[pos] = REMOVED_SLOT;
+        _size--;
+
+        if(_pins != 0)
+        {
+            return true;
+        }
+
+        if(_size == 0)
+        {
+            Clear();
+        }
+        else if(_entries.size() > _size * 2 + MIN_CAPACITY)
+        {
+            // Mostly removed entries, compact so iteration stays proportional to the size
+            Rehash(_slots.size());
+        }
+
+        return true;
+    }
+
+    ObjectMap::ConstIterator ObjectMap::begin() const
+    {
+        return {_entries.data(),_entries.data() + _entries.size()};
+    }
+
+    ObjectMap::ConstIterator ObjectMap::end() const
+    {
+        return {_entries.data() + _entries.size(),_entries.data() + _entries.size()};
+    }
+
+    const std::vector<ObjectMap::Entry>& ObjectMap::GetEntries() const
+    {
+        return _entries;
+    }
+
+    size_t ObjectMap::GetLayoutVersion() const
+    {
+        return _layoutVersion;
+    }
+
+    void ObjectMap::Pin()
+    {
+        _pins++;
+    }
+
+    void ObjectMap::Unpin()
+    {
+        _pins--;
+    }
+
+    size_t ObjectMap::Hash(const std::shared_ptr<Object>& key)
+    {
+        switch (key->GetType())
+        {
+        case EObjectType::String:
+            // Strings cache their hash after the first call
+            return castStatic<String>(key)->String::GetHashCode({});
+        case EObjectType::Number:
+            return hashNumber(static_cast<const Number*>(key.get()));
+        default:
+            return key->GetHashCode({});
+        }
+    }
+
+    size_t ObjectMap::HashInteger(int64_t value)
+    {
+        return std::hash<int64_t>{}(value);
+    }
+
+    size_t ObjectMap::HashFloating(double value)
+    {
+        // Whole values hash like the matching integer so 1 and 1.0 find the same entry
+        if(std::trunc(value) == value && std::abs(value) < 9.2e18)
+        {
+            return HashInteger(static_cast<int64_t>(value));
+        }
+
+        return std::hash<double>{}(value);
+    }
+
+    bool ObjectMap::KeysEqual(const std::shared_ptr<Object>& a, const std::shared_ptr<Object>& b)
+    {
+        if(a.get() == b.get())
+        {
+            return true;
+        }
+
+        if(a->GetType() != b->GetType())
+        {
+            return false;
+        }
+
+        switch (a->GetType())
+        {
+        case EObjectType::String:
+            return castStatic<String>(a)->GetView() == castStatic<String>(b)->GetView();
+        case EObjectType::Number:
+            {
+                const auto left = static_cast<const Number*>(a.get());
+                const auto right = static_cast<const Number*>(b.get());
+                if(isIntegral(left) && isIntegral(right))
+                {
+                    return integralValue(left) == integralValue(right);
+                }
+
+                return floatingValue(left) == floatingValue(right);
+            }
+        default:
+            return a->Equal(b,{});
+        }
+    }
+
+    size_t ObjectMap::FindSlot(const std::shared_ptr<Object>& key, size_t hash) const
+    {
+        if(_slots.empty())
+        {
+            return 0;
+        }
+
+        const auto mixed = mixHash(hash);
+        const auto tag = static_cast<uint32_t>(mixed);
+        const auto mask = _slots.size() - 1;
+        for(auto pos = static_cast<size_t>(mixed >> _shift);; pos = (pos + 1) & mask)
+        {
+            const auto slot = _slots[pos];
+            if(slot == EMPTY_SLOT)
+            {
+                return _slots.size();
+            }
+
+            if(slot != REMOVED_SLOT && static_cast<uint32_t>(slot >> 32) == tag)
+            {
+                if(const auto& entry = _entries[static_cast<uint32_t>(slot) - 2]; entry.hash == hash && KeysEqual(entry.key,key))
+                {
+                    return pos;
+                }
+            }
+        }
+    }
+
+    void ObjectMap::Rehash(size_t capacity)
+    {
+        // Drops removed entries, the survivors keep their relative order
+        if(_size != _entries.size() && _pins == 0)
+        {
+            std::erase_if(_entries,[](const Entry& entry)
+            {
+                return !entry.key;
+            });
+            _layoutVersion++;
+        }
+
+        _slots.assign(capacity,EMPTY_SLOT);
+        _shift = 64 - std::countr_zero(capacity);
+
+        const auto mask = capacity - 1;
+        for(size_t i = 0; i < _entries.size(); i++)
+        {
+            if(!_entries[i].key)
+            {
+                continue;
+            }
+
+            const auto mixed = mixHash(_entries[i].hash);
+            auto pos = static_cast<size_t>(mixed >> _shift);
+            while(_slots[pos] != EMPTY_SLOT)
+            {
+                pos = (pos + 1) & mask;
+            }
+
+            _slots[pos] = (static_cast<uint64_t>(static_cast<uint32_t>(mixed)) << 32) | (i + 2);
+        }
+    }
+}
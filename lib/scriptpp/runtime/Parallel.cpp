@@ -0,0 +1,677 @@
+#include "scriptpp/runtime/Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <ranges>
+#include <set>
+#include <unordered_set>
+
+#include "scriptpp/frontend/parser.hpp"
+#include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Iterator.hpp"
+#include "scriptpp/runtime/Memoize.hpp"
+#include "scriptpp/runtime/NativeCall.hpp"
+#include "scriptpp/runtime/Prototype.hpp"
+
+namespace spp::runtime
+{
+    struct WorkerPool::Job
+    {
+        size_t count = 0;
+        size_t grain = 1;
+        const std::function<void(size_t,size_t)>* body = nullptr;
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::mutex errorMutex{};
+        std::exception_ptr error{};
+        // Workers currently inside RunChunks, guarded by the pool mutex
+        size_t running = 0;
+
+        bool IsExhausted() const
+        {
+            return failed.load(std::memory_order_relaxed) || next.load(std::memory_order_relaxed) >= count;
+        }
+    };
+
+    WorkerPool::WorkerPool(size_t workers)
+    {
+        _workers.reserve(workers);
+        for (size_t i = 0; i < workers; i++)
+        {
+            _workers.emplace_back(&WorkerPool::WorkerLoop,this);
+        }
+    }
+
+    void WorkerPool::WorkerLoop()
+    {
+        std::unique_lock lock(_mutex);
+        while (true)
+        {
+            _wake.wait(lock,[this]
+            {
+                return _stopping || !_jobs.empty();
+            });
+
+            if (_stopping)
+            {
+                return;
+            }
+
+            const auto job = _jobs.front();
+
+            // Every chunk is claimed already, the owner finishes it
+            if (job->IsExhausted())
+            {
+                _jobs.pop_front();
+                continue;
+            }
+
+            job->running++;
+            lock.unlock();
+            RunChunks(*job);
+            lock.lock();
+
+            if (--job->running == 0)
+            {
+                _done.notify_all();
+            }
+        }
+    }
+
+    void WorkerPool::RunChunks(Job& job)
+    {
+        while (!job.failed.load(std::memory_order_relaxed))
+        {
+            const auto begin = job.next.fetch_add(job.grain);
+            if (begin >= job.count)
+            {
+                return;
+            }
+
+            try
+            {
+                (*job.body)(begin,std::min(begin + job.grain,job.count));
+            }
+            catch (...)
+            {
+                std::lock_guard guard(job.errorMutex);
+                if (!job.error)
+                {
+                    job.error = std::current_exception();
+                }
+                job.failed = true;
+            }
+        }
+    }
+
+    WorkerPool& WorkerPool::Get()
+    {
+        static WorkerPool pool(std::max<size_t>(std::thread::hardware_concurrency(),1) - 1);
+        return pool;
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard guard(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+
+        for (auto& worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t WorkerPool::GetSize() const
+    {
+        return _workers.size() + 1;
+    }
+
+    void WorkerPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t,size_t)>& body)
+    {
+        grain = std::max<size_t>(grain,1);
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (_workers.empty() || count <= grain)
+        {
+            body(0,count);
+            return;
+        }
+
+        const auto job = std::make_shared<Job>();
+        job->count = count;
+        job->grain = grain;
+        job->body = &body;
+
+        {
+            std::lock_guard guard(_mutex);
+            _jobs.push_back(job);
+        }
+        _wake.notify_all();
+
+        RunChunks(*job);
+
+        {
+            std::unique_lock lock(_mutex);
+            if (const auto it = std::ranges::find(_jobs,job); it != _jobs.end())
+            {
+                _jobs.erase(it);
+            }
+
+            _done.wait(lock,[&job]
+            {
+                return job->running == 0;
+            });
+        }
+
+        if (job->error)
+        {
+            std::rethrow_exception(job->error);
+        }
+    }
+
+    namespace
+    {
+        // Builtin methods that only read their receiver. Anything else called on an object the callback did not create
+        // may write to memory other threads are reading
+        const std::unordered_set<std::string> readOnlyMethods = {
+            "contains","endsWith","indexOf","repeat","replace","slice","split","startsWith","toLower","toUpper","trim",
+            "size","join","sum","min","max","mean","dot","scale","add","find","findIndex","forEach","map","filter",
+            "get","has","keys","values","items","toList","iter"
+        };
+
+        // Builtin methods that write to their receiver, taking one as a value lets the callback call it later
+        const std::unordered_set<std::string> mutatingMethods = {
+            "push","pop","sort","sortBy","reverse","put","remove","clear","update","reserve","append","appendLine",
+            "next","collect","intern","parallelMap","parallelFilter","parallelForEach"
+        };
+
+        // Free natives that are safe to call from several threads, any other native a callback reaches through a
+        // capture is rejected since nothing is known about what it writes
+        const std::unordered_set<std::string> threadSafeNatives = {
+            "print","cwd","memoize"
+        };
+
+        // Statically walks a function body looking for writes that other threads could observe. Only variables holding
+        // an object the callback constructed itself may be written to, values reached through parameters or captures
+        // are shared even when a local names them
+        struct IsolationCheck
+        {
+            std::shared_ptr<ScopeLike> scope{};
+            std::set<std::string> locals{};
+            std::unordered_set<const frontend::Node*>* visited = nullptr;
+            std::string issue{};
+            // Locals that may hold a value the callback did not construct
+            std::set<std::string> shared{};
+
+            bool IsLocal(const std::string& id) const
+            {
+                return locals.contains(id);
+            }
+
+            // Locals that only ever hold objects made by this call
+            bool IsOwned(const std::string& id) const
+            {
+                return IsLocal(id) && !shared.contains(id);
+            }
+
+            std::shared_ptr<Object> Resolve(const std::string& id) const
+            {
+                if (const auto found = scope->Find(id))
+                {
+                    return resolveReference(found);
+                }
+
+                return {};
+            }
+
+            bool Fail(const std::string& reason)
+            {
+                issue = reason;
+                return false;
+            }
+
+            void Declare(const std::string& id,bool owned)
+            {
+                locals.insert(id);
+                if (!owned)
+                {
+                    shared.insert(id);
+                }
+            }
+
+            // Whether node always evaluates to an object created by the call itself
+            bool IsFresh(const std::shared_ptr<frontend::Node>& node) const
+            {
+                switch (node->type)
+                {
+                case frontend::NodeType::NumericLiteral:
+                case frontend::NodeType::StringLiteral:
+                case frontend::NodeType::BooleanLiteral:
+                case frontend::NodeType::NullLiteral:
+                case frontend::NodeType::ListLiteral:
+                case frontend::NodeType::Function:
+                    return true;
+                case frontend::NodeType::Identifier:
+                    return IsOwned(std::dynamic_pointer_cast<frontend::IdentifierNode>(node)->value);
+                case frontend::NodeType::BinaryOp:
+                    {
+                        const auto op = std::dynamic_pointer_cast<frontend::BinaryOpNode>(node);
+                        return IsFresh(op->left) && IsFresh(op->right);
+                    }
+                case frontend::NodeType::Call:
+                    {
+                        // Builtin constructors, script classes run script code that may hand back anything
+                        const auto callee = std::dynamic_pointer_cast<frontend::IdentifierNode>(std::dynamic_pointer_cast<frontend::CallNode>(node)->left);
+                        if (!callee || IsLocal(callee->value))
+                        {
+                            return false;
+                        }
+
+                        const auto prototype = cast<Prototype>(Resolve(callee->value));
+                        return prototype && !cast<RuntimePrototype>(prototype);
+                    }
+                default:
+                    return false;
+                }
+            }
+
+            static std::string Describe(const std::shared_ptr<frontend::Node>& node)
+            {
+                if (const auto root = FindRoot(node))
+                {
+                    return "'" + root->value + "'";
+                }
+
+                return "an expression";
+            }
+
+            // Runs the check again until no more locals turn out to be shared, a use before the assignment that makes
+            // a local shared would otherwise be accepted
+            bool CheckFunction(const std::shared_ptr<frontend::FunctionNode>& fn)
+            {
+                while (true)
+                {
+                    const auto sharedCount = shared.size();
+                    locals.clear();
+                    if (!CheckFunctionOnce(fn))
+                    {
+                        return false;
+                    }
+
+                    if (shared.size() == sharedCount)
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            bool CheckFunctionOnce(const std::shared_ptr<frontend::FunctionNode>& fn)
+            {
+                for (auto& param : fn->params)
+                {
+                    Declare(param->name,false);
+                    if (param->defaultValue && !Check(param->defaultValue))
+                    {
+                        return false;
+                    }
+                }
+
+                return Check(fn->body);
+            }
+
+            // Calls to other script functions are checked against the scope they were declared in
+            bool CheckCallee(const std::shared_ptr<frontend::IdentifierNode>& callee)
+            {
+                if (IsLocal(callee->value))
+                {
+                    return true;
+                }
+
+                if (callee->value == "eval" || callee->value == "import")
+                {
+                    return Fail("callback calls '" + callee->value + "'");
+                }
+
+                auto resolved = Resolve(callee->value);
+
+                // Memoized functions run the function they wrap
+                while (const auto memoized = cast<MemoizedFunction>(resolved))
+                {
+                    resolved = memoized->GetWrapped();
+                }
+
+                // Constructors only write to the object they make
+                if (!resolved || cast<Prototype>(resolved))
+                {
+                    return true;
+                }
+
+                const auto target = cast<RuntimeFunction>(resolved);
+                if (!target)
+                {
+                    return CheckNativeCallee(callee->value,cast<Function>(resolved));
+                }
+
+                if (visited->contains(target->GetNode().get()))
+                {
+                    return true;
+                }
+
+                visited->insert(target->GetNode().get());
+
+                IsolationCheck nested{target->GetDeclarationScope(),{},visited};
+                if (!nested.CheckFunction(target->GetNode()))
+                {
+                    return Fail(nested.issue + " (in '" + callee->value + "')");
+                }
+
+                return true;
+            }
+
+            // A captured native, called or passed along, is either a method taken off an object, which is judged by its name like a method
+            // call on a shared receiver, or a free function that has to be on the allowlist
+            bool CheckNativeCallee(const std::string& id,const std::shared_ptr<Function>& fn)
+            {
+                // Plain values, calling one fails on its own
+                if (!fn)
+                {
+                    return true;
+                }
+
+                const auto fast = cast<FastNativeFunction>(fn);
+                const auto self = fast ? fast->GetSelf() : fn->GetOwner();
+                if (self)
+                {
+                    if (mutatingMethods.contains(fn->GetName()) || !readOnlyMethods.contains(fn->GetName()))
+                    {
+                        return Fail("callback calls method '" + fn->GetName() + "' of a shared object through '" + id + "'");
+                    }
+
+                    return true;
+                }
+
+                if (!threadSafeNatives.contains(fn->GetName()))
+                {
+                    return Fail("callback calls native '" + id + "' which may not be thread safe");
+                }
+
+                return true;
+            }
+
+            // Follows a chain of a.b[c].d back to the variable it starts from
+            static std::shared_ptr<frontend::IdentifierNode> FindRoot(std::shared_ptr<frontend::Node> node)
+            {
+                while (node->type == frontend::NodeType::Access || node->type == frontend::NodeType::Index)
+                {
+                    node = std::dynamic_pointer_cast<frontend::HasLeft>(node)->left;
+                }
+
+                return std::dynamic_pointer_cast<frontend::IdentifierNode>(node);
+            }
+
+            // Only an owned local itself may be written to, members and items of it can be shared objects
+            bool CanWrite(const std::shared_ptr<frontend::Node>& target) const
+            {
+                const auto id = std::dynamic_pointer_cast<frontend::IdentifierNode>(target);
+                return id && IsOwned(id->value);
+            }
+
+            static std::string MemberName(const std::shared_ptr<frontend::AccessNode>& access)
+            {
+                const auto id = std::dynamic_pointer_cast<frontend::IdentifierNode>(access->right);
+                return id ? id->value : std::string{};
+            }
+
+            bool CheckAssign(const std::shared_ptr<frontend::AssignNode>& assign)
+            {
+                if (assign->left->type == frontend::NodeType::Identifier)
+                {
+                    const auto id = std::dynamic_pointer_cast<frontend::IdentifierNode>(assign->left)->value;
+                    if (!IsLocal(id))
+                    {
+                        return Fail("callback assigns to captured variable '" + id + "'");
+                    }
+
+                    if (!IsFresh(assign->value))
+                    {
+                        shared.insert(id);
+                    }
+                }
+                else
+                {
+                    const auto target = std::dynamic_pointer_cast<frontend::HasLeft>(assign->left);
+                    if (!target)
+                    {
+                        return Fail("callback assigns into an object it did not create");
+                    }
+
+                    if (!CanWrite(target->left))
+                    {
+                        return Fail("callback modifies " + Describe(target->left) + ", which it did not create");
+                    }
+
+                    if (!Check(assign->left))
+                    {
+                        return false;
+                    }
+                }
+
+                return Check(assign->value);
+            }
+
+            bool CheckMethodCall(const std::shared_ptr<frontend::AccessNode>& access)
+            {
+                if (CanWrite(access->left))
+                {
+                    return true;
+                }
+
+                const auto name = MemberName(access);
+                if (readOnlyMethods.contains(name))
+                {
+                    return true;
+                }
+
+                // Captured immutable values and prototypes are safe to share whatever the method is
+                if (const auto id = std::dynamic_pointer_cast<frontend::IdentifierNode>(access->left); id && !IsLocal(id->value))
+                {
+                    const auto receiver = Resolve(id->value);
+                    const auto type = receiver ? receiver->GetType() : EObjectType::Null;
+                    if (type == EObjectType::String || type == EObjectType::Number || type == EObjectType::Boolean || cast<Prototype>(receiver))
+                    {
+                        return true;
+                    }
+                }
+
+                return Fail("callback calls '" + name + "' on " + Describe(access->left) + ", which it did not create");
+            }
+
+            bool CheckCall(const std::shared_ptr<frontend::CallNode>& call)
+            {
+                switch (call->left->type)
+                {
+                case frontend::NodeType::Identifier:
+                    if (!CheckCallee(std::dynamic_pointer_cast<frontend::IdentifierNode>(call->left)))
+                    {
+                        return false;
+                    }
+                    break;
+                case frontend::NodeType::Access:
+                    {
+                        const auto access = std::dynamic_pointer_cast<frontend::AccessNode>(call->left);
+                        if (!CheckMethodCall(access) || !Check(access->left))
+                        {
+                            return false;
+                        }
+                    }
+                    break;
+                default:
+                    if (!Check(call->left))
+                    {
+                        return false;
+                    }
+                }
+
+                for (auto& arg : call->positionalArguments)
+                {
+                    if (!Check(arg))
+                    {
+                        return false;
+                    }
+                }
+
+                for (auto& arg : call->namedArguments | std::views::values)
+                {
+                    if (!Check(arg))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            bool CheckAll(const std::vector<std::shared_ptr<frontend::Node>>& nodes)
+            {
+                return std::ranges::all_of(nodes,[this](const std::shared_ptr<frontend::Node>& node)
+                {
+                    return Check(node);
+                });
+            }
+
+            bool Check(const std::shared_ptr<frontend::Node>& node)
+            {
+                if (!node)
+                {
+                    return true;
+                }
+
+                switch (node->type)
+                {
+                case frontend::NodeType::CreateAndAssign:
+                    {
+                        const auto create = std::dynamic_pointer_cast<frontend::CreateAndAssignNode>(node);
+                        const auto owned = create->value && IsFresh(create->value);
+                        for (auto& id : create->identifiers)
+                        {
+                            Declare(id,owned);
+                        }
+                        return Check(create->value);
+                    }
+                case frontend::NodeType::Assign:
+                    return CheckAssign(std::dynamic_pointer_cast<frontend::AssignNode>(node));
+                case frontend::NodeType::Call:
+                    return CheckCall(std::dynamic_pointer_cast<frontend::CallNode>(node));
+                case frontend::NodeType::Identifier:
+                    // A script function passed along as a value may be called by whatever receives it
+                    return CheckCallee(std::dynamic_pointer_cast<frontend::IdentifierNode>(node));
+                case frontend::NodeType::Function:
+                    {
+                        // Nested lambdas run on the same thread and may use our locals
+                        const auto fn = std::dynamic_pointer_cast<frontend::FunctionNode>(node);
+                        if (!fn->name.empty())
+                        {
+                            Declare(fn->name,true);
+                        }
+                        return CheckFunctionOnce(fn);
+                    }
+                case frontend::NodeType::BinaryOp:
+                    {
+                        const auto op = std::dynamic_pointer_cast<frontend::BinaryOpNode>(node);
+                        return Check(op->left) && Check(op->right);
+                    }
+                case frontend::NodeType::Access:
+                    {
+                        // A bound method taken as a value keeps its receiver
+                        const auto access = std::dynamic_pointer_cast<frontend::AccessNode>(node);
+                        if (!CanWrite(access->left) && mutatingMethods.contains(MemberName(access)))
+                        {
+                            return Fail("callback takes '" + MemberName(access) + "' of " + Describe(access->left) + ", which it did not create");
+                        }
+                        return Check(access->left);
+                    }
+                case frontend::NodeType::Index:
+                    {
+                        const auto index = std::dynamic_pointer_cast<frontend::IndexNode>(node);
+                        return Check(index->left) && Check(index->within);
+                    }
+                case frontend::NodeType::ListLiteral:
+                    return CheckAll(std::dynamic_pointer_cast<frontend::ListLiteralNode>(node)->values);
+                case frontend::NodeType::Scope:
+                    return CheckAll(std::dynamic_pointer_cast<frontend::ScopeNode>(node)->statements);
+                case frontend::NodeType::Return:
+                    return Check(std::dynamic_pointer_cast<frontend::ReturnNode>(node)->expression);
+                case frontend::NodeType::Throw:
+                    return Check(std::dynamic_pointer_cast<frontend::ThrowNode>(node)->expression);
+                case frontend::NodeType::When:
+                    {
+                        for (auto& branch : std::dynamic_pointer_cast<frontend::WhenNode>(node)->branches)
+                        {
+                            if (!Check(branch.expression) || !Check(branch.statement))
+                            {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+                case frontend::NodeType::For:
+                    {
+                        const auto loop = std::dynamic_pointer_cast<frontend::ForNode>(node);
+                        return Check(loop->init) && Check(loop->condition) && Check(loop->update) && Check(loop->body);
+                    }
+                case frontend::NodeType::ForIn:
+                    {
+                        const auto loop = std::dynamic_pointer_cast<frontend::ForInNode>(node);
+                        Declare(loop->id,false);
+
+                        // Iterating an iterator advances it
+                        if (const auto id = std::dynamic_pointer_cast<frontend::IdentifierNode>(loop->iterable); id && !IsLocal(id->value) && cast<Iterator>(Resolve(id->value)))
+                        {
+                            return Fail("callback iterates captured iterator '" + id->value + "'");
+                        }
+                        return Check(loop->iterable) && Check(loop->body);
+                    }
+                case frontend::NodeType::While:
+                    {
+                        const auto loop = std::dynamic_pointer_cast<frontend::WhileNode>(node);
+                        return Check(loop->condition) && Check(loop->body);
+                    }
+                case frontend::NodeType::TryCatch:
+                    {
+                        const auto tryCatch = std::dynamic_pointer_cast<frontend::TryCatchNode>(node);
+                        Declare(tryCatch->catchArgumentName,false);
+                        return Check(tryCatch->tryScope) && Check(tryCatch->catchScope);
+                    }
+                case frontend::NodeType::Class:
+                    return Fail("callback declares a class");
+                default:
+                    return true;
+                }
+            }
+        };
+    }
+
+    void ensureIsolated(const std::string& method, const std::shared_ptr<Function>& fn, const std::shared_ptr<ScopeLike>& scope)
+    {
+        const auto runtimeFn = cast<RuntimeFunction>(fn);
+        if (!runtimeFn)
+        {
+            throw makeException(scope,method + " requires a script function, native functions can't be checked for isolation");
+        }
+
+        std::unordered_set<const frontend::Node*> visited{runtimeFn->GetNode().get()};
+        IsolationCheck check{runtimeFn->GetDeclarationScope(),{},&visited};
+        if (!check.CheckFunction(runtimeFn->GetNode()))
+        {
+            throw makeException(scope,method + " cannot guarantee isolation: " + check.issue);
+        }
+    }
+}
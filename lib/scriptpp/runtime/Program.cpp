@@ -8,8 +8,11 @@
 #include "scriptpp/runtime/Dictionary.hpp"
 #include "scriptpp/runtime/Exception.hpp"
 #include "scriptpp/runtime/eval.hpp"
+#include "scriptpp/runtime/Memoize.hpp"
 #include "scriptpp/runtime/Null.hpp"
+#include "scriptpp/runtime/StringBuilder.hpp"
 #include "scriptpp/runtime/Thread.hpp"
+#include "scriptpp/runtime/Tuple.hpp"
 
 namespace spp::runtime
 {
@@ -40,14 +43,23 @@ namespace spp::runtime
             return Eval(scope);
         });
 
+        // memoize(fn) or memoize(fn, maxSize)
+        AddLambda("memoize",{"fn","maxSize"},memoize);
+
         // list support
         Set("List",List::Prototype);
 
         // Dictionary support
         Set("Dict",Dictionary::Prototype);
 
+        // Immutable composite keys
+        Set("Tuple",Tuple::Prototype);
+
         // Thread support
-        Set("Thread",Thread::Prototype);
+        Set("Thread",Thread::GetClass().GetPrototype());
+
+        // Efficient string building
+        Set("StringBuilder",StringBuilder::Prototype);
     }
 
     std::shared_ptr<Module> Program::ImportModule(const std::string& id)
@@ -2,6 +2,7 @@
 #include <stdexcept>
 
 #include "scriptpp/utils.hpp"
+#include "scriptpp/runtime/FramePool.hpp"
 #include "scriptpp/runtime/Function.hpp"
 #include "scriptpp/runtime/Null.hpp"
 
@@ -9,21 +10,28 @@ namespace spp::runtime
 {
     Scope::Scope()
     {
-        _scopeStack = {GetScopeType()};
+        _scopeMask = scopeTypeBit(_scopeType);
     };
 
-    Scope::Scope(const std::shared_ptr<ScopeLike>& outer)
+    // The type is passed in because GetScopeType can't reach derived classes while the base is being constructed
+    Scope::Scope(const std::shared_ptr<ScopeLike>& outer,EScopeType type)
     {
+        _scopeType = type;
+        Rebind(outer);
+    }
+
+    void Scope::Rebind(const std::shared_ptr<ScopeLike>& outer)
+    {
+        _data.clear();
         _outer = outer;
-        if(_outer)
-        {
-            _scopeStack = outer->GetScopeStack();
-        }
-        
-        if(_scopeStack.empty() || GetScopeType() != _scopeStack.front())
-        {
-            _scopeStack.push_back(GetScopeType());
-        }
+        _scopeMask = (_outer ? _outer->GetScopeMask() : 0) | scopeTypeBit(_scopeType);
+    }
+
+    void Scope::Clear()
+    {
+        _data.clear();
+        _outer.reset();
+        _scopeMask = scopeTypeBit(_scopeType);
     }
 
     std::string Scope::ToString(const std::shared_ptr<ScopeLike>& scope) const
@@ -86,13 +94,13 @@ namespace spp::runtime
         _scope = scope;
     }
 
-    std::list<EScopeType> ScopeLikeProxyShared::GetScopeStack() const
+    ScopeTypeMask ScopeLikeProxyShared::GetScopeMask() const
     {
         if(_scope)
         {
-            return _scope->GetScopeStack();
+            return _scope->GetScopeMask();
         }
-        return {};
+        return 0;
     }
 
     bool ScopeLikeProxyShared::HasScopeType(EScopeType type) const
@@ -160,14 +168,14 @@ namespace spp::runtime
         _scope = scope;
     }
 
-    std::list<EScopeType> ScopeLikeProxyWeak::GetScopeStack() const
+    ScopeTypeMask ScopeLikeProxyWeak::GetScopeMask() const
     {
         if(const auto s = _scope.lock())
         {
-            return s->GetScopeStack();
+            return s->GetScopeMask();
         }
 
-        return {};
+        return 0;
     }
 
     bool ScopeLikeProxyWeak::HasScopeType(EScopeType type) const
@@ -242,6 +250,17 @@ namespace spp::runtime
         return _calledAt.has_value() ? _calledAt->ToString() : "<native>";
     }
 
+    void CallScope::Reset(const std::optional<frontend::TokenDebugInfo>& calledAt, const std::shared_ptr<ScopeLike>& scope)
+    {
+        _calledAt = calledAt;
+        _scope = scope;
+    }
+
+    void CallScope::Release()
+    {
+        _scope.reset();
+    }
+
     Reference::Reference(const std::shared_ptr<ScopeLike>& scope, const std::shared_ptr<Object>& val)
     {
         _scope = scope;
@@ -253,6 +272,11 @@ namespace spp::runtime
         return _data;
     }
 
+    std::shared_ptr<ScopeLike> Reference::GetScope() const
+    {
+        return _scope;
+    }
+
     void Reference::Set(const std::shared_ptr<Object>& val)
     {
        _data = val;
@@ -263,19 +287,19 @@ namespace spp::runtime
         return EObjectType::Scope;
     }
     
-    std::list<EScopeType> Scope::GetScopeStack() const
+    ScopeTypeMask Scope::GetScopeMask() const
     {
-        return _scopeStack;
+        return _scopeMask;
     }
 
     bool Scope::HasScopeType(const EScopeType type) const
     {
-        return type == GetScopeType() || std::ranges::find(_scopeStack,type) != _scopeStack.end();
+        return (_scopeMask & scopeTypeBit(type)) != 0;
     }
 
     EScopeType Scope::GetScopeType() const
     {
-        return EScopeType::ST_None;
+        return _scopeType;
     }
 
     EObjectType Reference::GetType() const
@@ -357,9 +381,20 @@ namespace spp::runtime
     std::shared_ptr<CallScope> makeCallScope(const std::optional<frontend::TokenDebugInfo>& calledAt,
         const std::shared_ptr<ScopeLike>& scope)
     {
+        if(auto callScope = FramePool<CallScope>::Get().Take())
+        {
+            callScope->Reset(calledAt,scope);
+            return callScope;
+        }
+
         return std::make_shared<CallScope>(calledAt,scope);
     }
 
+    void releaseCallScope(std::shared_ptr<CallScope>&& callScope)
+    {
+        FramePool<CallScope>::Get().Return(std::move(callScope));
+    }
+
     std::shared_ptr<Object> resolveReference(const std::shared_ptr<Object>& obj)
     {
         if(!obj)
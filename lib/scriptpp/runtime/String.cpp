@@ -1,23 +1,168 @@
 #include "scriptpp/runtime/String.hpp"
 
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+#include "scriptpp/strings.hpp"
 #include "scriptpp/utils.hpp"
+#include "scriptpp/runtime/Boolean.hpp"
+#include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Iterator.hpp"
 #include "scriptpp/runtime/List.hpp"
 #include "scriptpp/runtime/Null.hpp"
 #include "scriptpp/runtime/Number.hpp"
 
 namespace spp::runtime
 {
-    void String::Init()
+    namespace
+    {
+        std::shared_ptr<String> findStringArg(const std::shared_ptr<FunctionScope>& fnScope,const std::string& id)
+        {
+            const auto arg = resolveReference(fnScope->Find(id));
+            if(arg->GetType() == EObjectType::String)
+            {
+                return castStatic<String>(arg);
+            }
+
+            if(arg->GetType() == EObjectType::Null)
+            {
+                throw makeException(fnScope,id + " must be a string");
+            }
+
+            return makeString(arg->ToString(fnScope));
+        }
+
+        int64_t findIntegerArg(const std::shared_ptr<FunctionScope>& fnScope,const std::string& id,int64_t fallback)
+        {
+            const auto arg = resolveReference(fnScope->Find(id));
+            if(arg->GetType() == EObjectType::Null)
+            {
+                return fallback;
+            }
+
+            if(arg->GetType() != EObjectType::Number)
+            {
+                throw makeException(fnScope,id + " must be a number");
+            }
+
+            return castStatic<Number>(arg)->GetValueAs<int64_t>();
+        }
+    }
+
+    bool String::HasNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Has(id);
+    }
+
+    std::shared_ptr<Function> String::BindNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Bind(id,this);
+    }
+
+    String::String(const std::string& str,bool interned) : DynamicObject({}), _str(str), _size(_str.size()), _interned(interned)
     {
-        DynamicObject::Init();
-        AddNativeMemberFunction("split",this,{"delimiter"},&String::Split);
-        AddNativeMemberFunction("size",this,vectorOf<std::string>(),&String::Size);
-        AddNativeMemberFunction("size",this,vectorOf<std::string>(),&String::Size);
     }
 
-    String::String(const std::string& str) : DynamicObject({})
+    String::String(std::string&& str) : DynamicObject({}), _str(std::move(str)), _size(_str.size())
     {
-        _str = str;
+    }
+
+    String::String(const std::shared_ptr<String>& left, const std::shared_ptr<String>& right) : DynamicObject({}), _left(left), _right(right), _flat(false), _size(left->_size + right->_size)
+    {
+    }
+
+    String::String(const std::shared_ptr<String>& parent, size_t offset, size_t size) : DynamicObject({}), _flat(false), _parent(parent), _offset(offset), _size(size)
+    {
+    }
+
+    String::~String()
+    {
+        ReleaseChildren();
+    }
+
+    void String::ReleaseChildren() const
+    {
+        auto left = _left.exchange({});
+        auto right = _right.exchange({});
+        if(!left && !right)
+        {
+            return;
+        }
+        
+        // Loops like s = s + x build very deep ropes, release them iteratively so we don't overflow the stack
+        std::vector<std::shared_ptr<String>> pending{std::move(left),std::move(right)};
+        while(!pending.empty())
+        {
+            auto node = std::move(pending.back());
+            pending.pop_back();
+            
+            if(node && node.use_count() == 1)
+            {
+                pending.push_back(node->_left.exchange({}));
+                pending.push_back(node->_right.exchange({}));
+            }
+        }
+    }
+
+    void String::Flatten() const
+    {
+        if(_parent)
+        {
+            _str.assign(GetView());
+            return;
+        }
+        
+        std::string result;
+        result.reserve(_size);
+
+        // Nodes are held while they are pending, another thread may flatten one of them and release its children
+        std::vector<std::shared_ptr<String>> pending{_right.load(),_left.load()};
+        while(!pending.empty())
+        {
+            const auto node = std::move(pending.back());
+            pending.pop_back();
+
+            if(node->_flat.load(std::memory_order_acquire) || node->_parent)
+            {
+                result += node->GetView();
+                continue;
+            }
+
+            // Children are only released after the node is published as flat
+            auto left = node->_left.load();
+            auto right = node->_right.load();
+            if(!left || !right)
+            {
+                result += node->GetView();
+                continue;
+            }
+
+            pending.push_back(std::move(right));
+            pending.push_back(std::move(left));
+        }
+
+        _str = std::move(result);
+    }
+
+    const NativeMethodTable<String>& String::GetMethods()
+    {
+        static const auto methods = NativeMethodTable<String>()
+            .Add("split",vectorOf<std::string>("delimiter"),&String::Split)
+            .Add("size",vectorOf<std::string>(),&String::Size)
+            .Add("trim",vectorOf<std::string>(),&String::Trim)
+            .Add("indexOf",vectorOf<std::string>("value","start"),&String::IndexOf)
+            .Add("contains",vectorOf<std::string>("value"),&String::Contains)
+            .Add("replace",vectorOf<std::string>("from","to"),&String::Replace)
+            .Add("startsWith",vectorOf<std::string>("prefix"),&String::StartsWith)
+            .Add("endsWith",vectorOf<std::string>("suffix"),&String::EndsWith)
+            .Add("toUpper",vectorOf<std::string>(),&String::ToUpper)
+            .Add("toLower",vectorOf<std::string>(),&String::ToLower)
+            .Add("repeat",vectorOf<std::string>("times"),&String::Repeat)
+            .Add("slice",vectorOf<std::string>("start","end"),&String::Slice)
+            .Add("iter",vectorOf<std::string>(),&String::Iter);
+        
+        return methods;
     }
 
     EObjectType String::GetType() const
@@ -27,42 +172,94 @@ namespace spp::runtime
 
     std::string String::ToString(const std::shared_ptr<ScopeLike>& scope) const
     {
+        return std::string(GetView());
+    }
+
+    const std::string& String::GetNative() const
+    {
+        if(!_flat.load(std::memory_order_acquire))
+        {
+            std::call_once(_flattenOnce,[this]
+            {
+                Flatten();
+                _flat.store(true,std::memory_order_release);
+
+                // Earlier prefixes of s = s + x loops would otherwise stay alive through every later node
+                ReleaseChildren();
+            });
+        }
         
         return _str;
     }
 
-    bool String::ToBoolean(const std::shared_ptr<ScopeLike>& scope) const
+    std::string_view String::GetView() const
+    {
+        if(_parent)
+        {
+            return std::string_view(_parent->_str).substr(_offset,_size);
+        }
+        
+        return GetNative();
+    }
+
+    size_t String::GetSize() const
     {
-        return _str.empty();
+        return _size;
     }
 
-    bool String::Equal(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope) const
+    bool String::IsInterned() const
     {
-        return _str == other->ToString(scope);
+        return _interned;
     }
 
-    std::shared_ptr<Object> String::Split(const std::shared_ptr<FunctionScope>& fnScope)
+    bool String::ToBoolean(const std::shared_ptr<ScopeLike>& scope) const
     {
-        std::vector<std::string> result;
-        auto delimiter = resolveReference(fnScope->Find("delimiter"));
-        if(delimiter->Equal(makeNull(),fnScope))
+        return _size != 0;
+    }
+
+    bool String::Equal(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope) const
+    {
+        if(other.get() == this)
         {
-            delimiter = makeString("");
+            return true;
         }
         
-        if (delimiter->Equal(makeNull(), fnScope))
-        {
-            split(result, _str, delimiter->ToString(fnScope));
-        }
-        else
+        if(other->GetType() == EObjectType::String)
         {
-            split(result, _str,"");
+            const auto asString = castStatic<String>(other);
+
+            // There is only ever one interned instance per value
+            if(_interned && asString->_interned)
+            {
+                return false;
+            }
+
+            if(const auto a = _hash.load(std::memory_order_relaxed), b = asString->_hash.load(std::memory_order_relaxed); a != 0 && b != 0 && a != b)
+            {
+                return false;
+            }
+            
+            return _size == asString->_size && GetView() == asString->GetView();
         }
         
+        return GetView() == other->ToString(scope);
+    }
+
+    std::shared_ptr<Object> String::Split(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto delimiter = resolveReference(fnScope->Find("delimiter"));
+        const auto str = GetView();
+        
+        std::vector<std::string_view> parts;
+        strings::split(parts,str,delimiter->GetType() == EObjectType::Null ? std::string() : delimiter->ToString(fnScope));
+
         std::vector<std::shared_ptr<Object>> items;
-        for(auto &p : result)
+        items.reserve(parts.size());
+        
+        const auto self = castStatic<String>(this->GetRef());
+        for(auto &part : parts)
         {
-            items.emplace_back(makeString(p));
+            items.emplace_back(makeStringSlice(self,static_cast<size_t>(part.data() - str.data()),part.size()));
         }
         
         return makeList(items);
@@ -70,26 +267,102 @@ namespace spp::runtime
 
     std::shared_ptr<Object> String::Size(const std::shared_ptr<FunctionScope>& fnScope)
     {
-        return makeNumber(_str.size());
+        return makeNumber(static_cast<int64_t>(_size));
     }
 
     std::shared_ptr<Object> String::Trim(const std::shared_ptr<FunctionScope>& fnScope)
     {
-        return makeNumber(trim(_str));
+        const auto str = GetView();
+        const auto trimmed = strings::trim(str);
+        return makeStringSlice(castStatic<String>(this->GetRef()),static_cast<size_t>(trimmed.data() - str.data()),trimmed.size());
+    }
+
+    std::shared_ptr<Object> String::IndexOf(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto value = findStringArg(fnScope,"value");
+        const auto start = findIntegerArg(fnScope,"start",0);
+        if(start < 0)
+        {
+            throw makeException(fnScope,"start must not be negative");
+        }
+        
+        const auto pos = strings::find(GetView(),value->GetView(),static_cast<size_t>(start));
+        return makeNumber(pos == strings::npos ? static_cast<int64_t>(-1) : static_cast<int64_t>(pos));
+    }
+
+    std::shared_ptr<Object> String::Contains(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeBoolean(strings::contains(GetView(),findStringArg(fnScope,"value")->GetView()));
+    }
+
+    std::shared_ptr<Object> String::Replace(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto from = findStringArg(fnScope,"from");
+        const auto to = findStringArg(fnScope,"to");
+        if(!strings::contains(GetView(),from->GetView()))
+        {
+            return this->GetRef();
+        }
+        
+        return makeString(strings::replace(GetView(),from->GetView(),to->GetView()));
+    }
+
+    std::shared_ptr<Object> String::StartsWith(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeBoolean(strings::startsWith(GetView(),findStringArg(fnScope,"prefix")->GetView()));
+    }
+
+    std::shared_ptr<Object> String::EndsWith(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeBoolean(strings::endsWith(GetView(),findStringArg(fnScope,"suffix")->GetView()));
+    }
+
+    std::shared_ptr<Object> String::ToUpper(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeString(strings::toUpper(GetView()));
+    }
+
+    std::shared_ptr<Object> String::ToLower(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeString(strings::toLower(GetView()));
+    }
+
+    std::shared_ptr<Object> String::Repeat(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto times = findIntegerArg(fnScope,"times",1);
+        return makeString(strings::repeat(GetView(),static_cast<size_t>(std::max<int64_t>(times,0))));
+    }
+
+    std::shared_ptr<Object> String::Slice(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        const auto size = static_cast<int64_t>(_size);
+        auto start = findIntegerArg(fnScope,"start",0);
+        auto end = findIntegerArg(fnScope,"end",size);
+
+        // Negative bounds count from the end
+        start = std::clamp(start < 0 ? start + size : start,static_cast<int64_t>(0),size);
+        end = std::clamp(end < 0 ? end + size : end,static_cast<int64_t>(0),size);
+
+        return makeStringSlice(castStatic<String>(this->GetRef()),static_cast<size_t>(start),static_cast<size_t>(std::max(end - start,static_cast<int64_t>(0))));
+    }
+
+    std::shared_ptr<Object> String::Iter(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeIterator(this->GetRef(),fnScope);
     }
 
     std::shared_ptr<Object> String::Get(const std::shared_ptr<Object>& key, const std::shared_ptr<ScopeLike>& scope) const
     {
         if(key->GetType() == EObjectType::Number)
         {
-            const auto i = cast<Number>(key)->GetValueAs<int>();
+            const auto i = castStatic<Number>(key)->GetValueAs<int64_t>();
             
-            if(i >= static_cast<int>(_str.size()))
+            if(i < 0 || i >= static_cast<int64_t>(_size))
             {
-                throw std::runtime_error("Index out of range " + std::to_string(i));
+                throw makeException(scope,"Index out of range " + std::to_string(i));
             }
 
-            return makeReference(scope,makeString(_str.substr(i,1)));
+            return makeCharString(GetView()[i]);
         }
         
         return DynamicObject::Get(key,scope);
@@ -97,40 +370,59 @@ namespace spp::runtime
 
     void String::Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& val, const std::shared_ptr<ScopeLike>& scope)
     {
-        // if(key->GetType() == EObjectType::Number)
-        // {
-        //     const auto idx =cast<Number>(key)->GetValueAs<int>();
-        //     if(idx > 0 && idx < _str.size())
-        //     {
-        //         _str[idx]= val->ToString().at(0);
-        //         return;
-        //     }
-        //     
-        // }
-        DynamicObject::Set(key, val, scope);
+        throw makeException(scope,"Strings are immutable");
+    }
+
+    void String::Assign(const std::string& id, const std::shared_ptr<Object>& var)
+    {
+        throw makeException({},"Strings are immutable");
+    }
+
+    void String::Create(const std::string& id, const std::shared_ptr<Object>& var)
+    {
+        throw makeException({},"Strings are immutable");
     }
 
     size_t String::GetHashCode(const std::shared_ptr<ScopeLike>& scope)
     {
-        return hashCombine(GetType(),_str);
+        auto hash = _hash.load(std::memory_order_relaxed);
+        if(hash == 0)
+        {
+            hash = hashCombine(GetType(),GetView());
+            
+            // 0 marks the hash as not computed yet
+            if(hash == 0)
+            {
+                hash = 1;
+            }
+            
+            _hash.store(hash,std::memory_order_relaxed);
+        }
+        
+        return hash;
     }
 
     std::shared_ptr<Object> String::Add(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope)
     {
-        return makeString(_str + other->ToString(scope));
+        const auto right = other->GetType() == EObjectType::String ? castStatic<String>(other) : makeString(other->ToString(scope));
+        
+        if(_size + right->_size < ROPE_MIN_SIZE)
+        {
+            std::string result;
+            result.reserve(_size + right->_size);
+            result.append(GetView());
+            result.append(right->GetView());
+            return makeString(std::move(result));
+        }
+        
+        return makeObject<String>(castStatic<String>(this->GetRef()),right);
     }
 
     std::shared_ptr<Object> String::Multiply(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope)
     {
         TNUMBER_SANITY_MACRO({
-            auto d = static_cast<int>(o->GetValue());
-            std::string total;
-            for(auto i = 0; i < d; i++)
-            {
-                total += _str;
-            }
-
-            return makeString(total);
+            const auto times = static_cast<int64_t>(o->GetValue());
+            return makeString(strings::repeat(GetView(),static_cast<size_t>(std::max<int64_t>(times,0))));
         })
         
         return DynamicObject::Multiply(other, scope);
@@ -140,4 +432,96 @@ namespace spp::runtime
     {
         return makeObject<String>(str);
     }
+
+    std::shared_ptr<String> makeString(std::string&& str)
+    {
+        return makeObject<String>(std::move(str));
+    }
+
+    std::shared_ptr<String> makeStringSlice(const std::shared_ptr<String>& str, size_t offset, size_t size)
+    {
+        if(offset == 0 && size == str->GetSize())
+        {
+            return str;
+        }
+
+        if(size == 1)
+        {
+            return makeCharString(str->GetView()[offset]);
+        }
+
+        // Always point at the buffer that owns the data so views never chain
+        auto parent = str;
+        if(str->_parent)
+        {
+            parent = str->_parent;
+            offset += str->_offset;
+        }
+        else
+        {
+            parent->GetNative();
+        }
+
+        // Short slices and slices that would pin a much larger buffer are cheaper as a copy
+        if(size < String::VIEW_MIN_SIZE || size * String::VIEW_MAX_WASTE < parent->GetSize())
+        {
+            return makeString(std::string(std::string_view(parent->_str).substr(offset,size)));
+        }
+
+        return makeObject<String>(parent,offset,size);
+    }
+
+    std::shared_ptr<String> makeCharString(char c)
+    {
+        static const auto chars = []
+        {
+            std::array<std::shared_ptr<String>,256> result;
+            for(size_t i = 0; i < result.size(); i++)
+            {
+                result[i] = makeInternedString(std::string(1,static_cast<char>(i)));
+            }
+
+            return result;
+        }();
+
+        return chars[static_cast<unsigned char>(c)];
+    }
+
+    std::shared_ptr<String> makeInternedString(const std::string& str)
+    {
+        static std::mutex internMutex;
+        static std::unordered_map<std::string,std::weak_ptr<String>> interned;
+        static size_t purgeAt = 64;
+
+        std::lock_guard lock(internMutex);
+        
+        const auto it = interned.find(str);
+        if(it != interned.end())
+        {
+            if(auto existing = it->second.lock())
+            {
+                return existing;
+            }
+        }
+
+        auto result = makeObject<String>(str,true);
+        if(it != interned.end())
+        {
+            it->second = result;
+            return result;
+        }
+
+        // Literals from code that is no longer loaded are dropped in bulk once the table has doubled since the last sweep
+        if(interned.size() >= purgeAt)
+        {
+            std::erase_if(interned,[](const auto& entry)
+            {
+                return entry.second.expired();
+            });
+            purgeAt = std::max<size_t>(64,interned.size() * 2);
+        }
+
+        interned.emplace(str,result);
+        return result;
+    }
 }
@@ -0,0 +1,123 @@
+#include "scriptpp/runtime/StringBuilder.hpp"
+
+#include "scriptpp/utils.hpp"
+#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/String.hpp"
+
+namespace spp::runtime
+{
+    bool StringBuilder::HasNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Has(id);
+    }
+
+    std::shared_ptr<Function> StringBuilder::BindNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Bind(id,this);
+    }
+
+    StringBuilder::StringBuilder() : DynamicObject({})
+    {
+    }
+
+    std::shared_ptr<StringBuilderPrototype> StringBuilder::Prototype = makeObject<StringBuilderPrototype>();
+
+    const NativeMethodTable<StringBuilder>& StringBuilder::GetMethods()
+    {
+        static const auto methods = NativeMethodTable<StringBuilder>()
+            .Add("append",vectorOf<std::string>(),&StringBuilder::Append)
+            .Add("appendLine",vectorOf<std::string>(),&StringBuilder::AppendLine)
+            .Add("build",vectorOf<std::string>(),&StringBuilder::Build)
+            .Add("size",vectorOf<std::string>(),&StringBuilder::Size)
+            .Add("clear",vectorOf<std::string>(),&StringBuilder::Clear);
+        
+        return methods;
+    }
+
+    std::string StringBuilder::ToString(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        return _buffer;
+    }
+
+    bool StringBuilder::ToBoolean(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        return !_buffer.empty();
+    }
+
+    std::shared_ptr<Object> StringBuilder::Append(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        for (const auto& arg : fnScope->GetPositionalArgs())
+        {
+            const auto item = resolveReference(arg);
+            if(item->GetType() == EObjectType::String)
+            {
+                _buffer += castStatic<String>(item)->GetView();
+            }
+            else
+            {
+                _buffer += item->ToString(fnScope);
+            }
+        }
+        
+        return this->GetRef();
+    }
+
+    std::shared_ptr<Object> StringBuilder::AppendLine(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        Append(fnScope);
+        _buffer += '\n';
+        return this->GetRef();
+    }
+
+    std::shared_ptr<Object> StringBuilder::Build(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeString(_buffer);
+    }
+
+    std::shared_ptr<Object> StringBuilder::Size(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeNumber(static_cast<int64_t>(_buffer.size()));
+    }
+
+    std::shared_ptr<Object> StringBuilder::Clear(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        _buffer.clear();
+        return this->GetRef();
+    }
+
+    std::string& StringBuilder::GetNative()
+    {
+        return _buffer;
+    }
+
+    size_t StringBuilder::GetHashCode(const std::shared_ptr<ScopeLike>& scope)
+    {
+        return hashCombine(DynamicObject::GetHashCode(scope),GetAddress());
+    }
+
+    StringBuilderPrototype::StringBuilderPrototype() : Prototype(makeScope())
+    {
+    }
+
+    std::string StringBuilderPrototype::ToString(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        return "<Prototype : StringBuilder>";
+    }
+
+    std::shared_ptr<DynamicObject> StringBuilderPrototype::CreateInstance(std::shared_ptr<FunctionScope>& scope)
+    {
+        auto builder = makeStringBuilder();
+        builder->Append(scope);
+        return builder;
+    }
+
+    std::string StringBuilderPrototype::GetName() const
+    {
+        return "StringBuilder";
+    }
+
+    std::shared_ptr<StringBuilder> makeStringBuilder()
+    {
+        return makeObject<StringBuilder>();
+    }
+}
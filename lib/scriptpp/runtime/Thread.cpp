@@ -1,88 +1,53 @@
 ﻿#include "scriptpp/runtime/Thread.hpp"
 
-#include "scriptpp/runtime/Boolean.hpp"
 #include "scriptpp/runtime/eval.hpp"
 #include "scriptpp/runtime/Exception.hpp"
-#include "scriptpp/runtime/Null.hpp"
 
 namespace spp::runtime
 {
 
-    Thread::Thread(const std::shared_ptr<ScopeLike>& scope) : DynamicObject(scope)
+    Thread::Thread(const std::shared_ptr<Object>& callback, NativeCallContext& ctx)
     {
+        _fn = resolveCallable(callback,ctx.GetCallScope());
+        if(!_fn.first) throw makeException(ctx.GetScope(), "Invalid callback");
     }
 
-    std::shared_ptr<ThreadPrototype> Thread::Prototype = makeObject<ThreadPrototype>();
-
-    void Thread::Init()
+    void Thread::Start(NativeCallContext& ctx)
     {
-        DynamicObject::Init();
-        AddNativeMemberFunction(ReservedDynamicFunctions::CONSTRUCTOR,this,vectorOf<std::string>("callback"),&Thread::Constructor);
-        AddNativeMemberFunction("start",this,vectorOf<std::string>(),&Thread::Start);
-        AddNativeMemberFunction("isActive",this,vectorOf<std::string>(),&Thread::IsActive);
-        AddNativeMemberFunction("join",this,vectorOf<std::string>(),&Thread::Join);
-    }
-
-    std::shared_ptr<DynamicObject> Thread::CreateInstance(const std::shared_ptr<FunctionScope>& fnScope)
-    {
-        auto obj = makeThread({});
-        obj->Constructor(fnScope);
-        return obj;
-    }
-
-    std::shared_ptr<Object> Thread::Start(const std::shared_ptr<FunctionScope>& fnScope)
-    {
-        if(_thread.joinable()) throw makeException(fnScope,"Cannot start thread that has already been started");
+        if(_thread.joinable()) throw makeException(ctx.GetScope(),"Cannot start thread that has already been started");
         
-        auto myRef = GetRef();
+        auto myRef = ctx.GetSelf();
         
         _thread = std::thread([this,myRef]
         {
             _fn.first->Call(_fn.second);
         });
-        return makeNull();
     }
 
-    std::shared_ptr<Object> Thread::Join(const std::shared_ptr<FunctionScope>& fnScope)
+    void Thread::Join(NativeCallContext& ctx)
     {
         if(_thread.joinable())
         {
             _thread.join();
-            return makeNull();
+            return;
         }
 
-        throw makeException(fnScope,"cannot join thread");
-    }
-
-    std::shared_ptr<Object> Thread::IsActive(const std::shared_ptr<FunctionScope>& fnScope)
-    {
-        return makeBoolean(_thread.joinable());
+        throw makeException(ctx.GetScope(),"cannot join thread");
     }
 
-    std::shared_ptr<Object> Thread::Constructor(const std::shared_ptr<FunctionScope>& fnScope)
+    bool Thread::IsActive() const
     {
-        auto callback = resolveReference(fnScope->GetArgument(0));
-        _fn = resolveCallable(callback,fnScope);
-        if(!_fn.first) throw makeException(fnScope, "Invalid callback");
-        return makeNull();
+        return _thread.joinable();
     }
 
-    std::shared_ptr<Thread> makeThread(const std::shared_ptr<ScopeLike>& scope)
+    const bind::Class<Thread>& Thread::GetClass()
     {
-        return makeObject<Thread>(scope);
-    }
-
-    ThreadPrototype::ThreadPrototype() : Prototype({})
-    {
-    }
+        static const auto cls = bind::Class<Thread>("Thread")
+            .Constructor<const std::shared_ptr<Object>&,NativeCallContext&>(vectorOf<std::string>("callback"))
+            .Method<&Thread::Start>("start")
+            .Method<&Thread::IsActive>("isActive")
+            .Method<&Thread::Join>("join");
 
-    std::string ThreadPrototype::GetName() const
-    {
-        return "Thread";
-    }
-
-    std::shared_ptr<DynamicObject> ThreadPrototype::CreateInstance(std::shared_ptr<FunctionScope>& scope)
-    {
-        return Thread::CreateInstance(scope);
+        return cls;
     }
 }
@@ -0,0 +1,336 @@
+#include "scriptpp/runtime/Tuple.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#include "scriptpp/runtime/Boolean.hpp"
+#include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Iterator.hpp"
+#include "scriptpp/runtime/List.hpp"
+#include "scriptpp/runtime/Number.hpp"
+#include "scriptpp/runtime/ObjectMap.hpp"
+
+namespace spp::runtime
+{
+    namespace
+    {
+        std::vector<std::shared_ptr<Object>> collectArgs(const std::shared_ptr<FunctionScope>& fnScope)
+        {
+            std::vector<std::shared_ptr<Object>> args{};
+            args.reserve(fnScope->GetPositionalArgs().size());
+            for (auto &arg : fnScope->GetPositionalArgs())
+            {
+                args.push_back(resolveReference(arg));
+            }
+
+            return args;
+        }
+
+        std::shared_ptr<Object> freezeItem(const std::shared_ptr<Object>& item,std::vector<const List*>& visiting)
+        {
+            if (Tuple::IsImmutable(item))
+            {
+                return item;
+            }
+
+            if (const auto list = cast<List>(item))
+            {
+                if (std::ranges::find(visiting,list.get()) != visiting.end())
+                {
+                    throw std::runtime_error("A list inside a tuple can't contain itself");
+                }
+
+                visiting.push_back(list.get());
+                std::vector<std::shared_ptr<Object>> items;
+                items.reserve(list->GetSize());
+                for (size_t i = 0; i < list->GetSize(); i++)
+                {
+                    items.push_back(freezeItem(list->GetItem(i),visiting));
+                }
+                visiting.pop_back();
+
+                return makeTuple(std::move(items));
+            }
+
+            throw std::runtime_error("Tuple items must be immutable, " + item->ToString() + " can change after the tuple is made");
+        }
+    }
+
+    bool Tuple::HasNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Has(id);
+    }
+
+    std::shared_ptr<Function> Tuple::BindNativeMethod(const std::string& id) const
+    {
+        return GetMethods().Bind(id,this);
+    }
+
+    Tuple::Tuple(std::vector<std::shared_ptr<Object>>&& items, bool interned) : DynamicObject({}), _items(Freeze(std::move(items))), _hash(HashItems(_items)), _interned(interned)
+    {
+    }
+
+    std::shared_ptr<TuplePrototype> Tuple::Prototype = makeObject<TuplePrototype>();
+
+    const NativeMethodTable<Tuple>& Tuple::GetMethods()
+    {
+        static const auto methods = NativeMethodTable<Tuple>()
+            .Add("size",vectorOf<std::string>(),&Tuple::Size)
+            .Add("toList",vectorOf<std::string>(),&Tuple::ToList)
+            .Add("iter",vectorOf<std::string>(),&Tuple::Iter)
+            .Add("intern",vectorOf<std::string>(),&Tuple::Intern);
+
+        return methods;
+    }
+
+    std::vector<std::shared_ptr<Object>> Tuple::Freeze(std::vector<std::shared_ptr<Object>>&& items)
+    {
+        std::vector<const List*> visiting;
+        for (auto &item : items)
+        {
+            item = freezeItem(item,visiting);
+        }
+
+        return std::move(items);
+    }
+
+    bool Tuple::IsImmutable(const std::shared_ptr<Object>& item)
+    {
+        switch (item->GetType())
+        {
+        case EObjectType::Null:
+        case EObjectType::Number:
+        case EObjectType::String:
+        case EObjectType::Boolean:
+        case EObjectType::Callable:
+        case EObjectType::Function:
+        case EObjectType::Module:
+            return true;
+        default:
+            break;
+        }
+
+        // Both hash by identity or by immutable contents
+        return cast<Tuple>(item) || cast<runtime::Prototype>(item);
+    }
+
+    size_t Tuple::HashItems(const std::vector<std::shared_ptr<Object>>& items)
+    {
+        // Items hash the way dictionary keys do so 1 and 1.0 land on the same tuple
+        auto result = hashCombine(EObjectType::Dynamic,items.size());
+        for (auto &item : items)
+        {
+            result = hashCombine(result,ObjectMap::Hash(item));
+        }
+
+        return result;
+    }
+
+    const std::vector<std::shared_ptr<Object>>& Tuple::GetItems() const
+    {
+        return _items;
+    }
+
+    size_t Tuple::GetSize() const
+    {
+        return _items.size();
+    }
+
+    bool Tuple::IsInterned() const
+    {
+        return _interned;
+    }
+
+    bool Tuple::ItemsEqual(const std::vector<std::shared_ptr<Object>>& items) const
+    {
+        if (items.size() != _items.size())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            if (!ObjectMap::KeysEqual(_items[i],items[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::shared_ptr<Object> Tuple::Size(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeNumber(static_cast<int64_t>(_items.size()));
+    }
+
+    std::shared_ptr<Object> Tuple::ToList(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeList(_items);
+    }
+
+    std::shared_ptr<Object> Tuple::Iter(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeIterator(this->GetRef(),fnScope);
+    }
+
+    std::shared_ptr<Object> Tuple::Intern(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        if (_interned)
+        {
+            return this->GetRef();
+        }
+
+        return makeInternedTuple(std::vector(_items));
+    }
+
+    std::shared_ptr<Object> Tuple::Get(const std::shared_ptr<Object>& key, const std::shared_ptr<ScopeLike>& scope) const
+    {
+        if (key->GetType() == EObjectType::Number)
+        {
+            const auto i = castStatic<Number>(key)->GetValueAs<int64_t>();
+            if (i < 0 || i >= static_cast<int64_t>(_items.size()))
+            {
+                throw makeException(scope,"Index out of range " + std::to_string(i));
+            }
+
+            return _items[i];
+        }
+
+        return DynamicObject::Get(key,scope);
+    }
+
+    void Tuple::Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& val, const std::shared_ptr<ScopeLike>& scope)
+    {
+        throw makeException(scope,"Tuples are immutable");
+    }
+
+    void Tuple::Assign(const std::string& id, const std::shared_ptr<Object>& var)
+    {
+        throw makeException({},"Tuples are immutable");
+    }
+
+    void Tuple::Create(const std::string& id, const std::shared_ptr<Object>& var)
+    {
+        throw makeException({},"Tuples are immutable");
+    }
+
+    bool Tuple::Equal(const std::shared_ptr<Object>& other, const std::shared_ptr<ScopeLike>& scope) const
+    {
+        if (other.get() == this)
+        {
+            return true;
+        }
+
+        const auto tuple = dynamic_cast<const Tuple*>(other.get());
+        if (!tuple || tuple->_hash != _hash)
+        {
+            return false;
+        }
+
+        // There is only ever one interned instance per value
+        if (_interned && tuple->_interned)
+        {
+            return false;
+        }
+
+        return ItemsEqual(tuple->_items);
+    }
+
+    size_t Tuple::GetHashCode(const std::shared_ptr<ScopeLike>& scope)
+    {
+        return _hash;
+    }
+
+    bool Tuple::ToBoolean(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        return !_items.empty();
+    }
+
+    std::string Tuple::ToString(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        std::string result = "(";
+        for (size_t i = 0; i < _items.size(); i++)
+        {
+            result += _items[i]->GetType() == EObjectType::String ? "\"" + _items[i]->ToString(scope) + "\"" : _items[i]->ToString(scope);
+            if (i != _items.size() - 1)
+            {
+                result += " , ";
+            }
+        }
+
+        result += ")";
+        return result;
+    }
+
+    std::shared_ptr<Tuple> makeTuple(std::vector<std::shared_ptr<Object>>&& items)
+    {
+        return makeObject<Tuple>(std::move(items));
+    }
+
+    std::shared_ptr<Tuple> makeInternedTuple(std::vector<std::shared_ptr<Object>>&& items)
+    {
+        static std::mutex internMutex;
+        static std::unordered_multimap<size_t,std::weak_ptr<Tuple>> interned;
+        static size_t purgeAt = 64;
+
+        items = Tuple::Freeze(std::move(items));
+        const auto hash = Tuple::HashItems(items);
+
+        std::lock_guard lock(internMutex);
+
+        auto [begin,end] = interned.equal_range(hash);
+        for (auto it = begin; it != end; ++it)
+        {
+            if (const auto existing = it->second.lock(); existing && existing->ItemsEqual(items))
+            {
+                return existing;
+            }
+        }
+
+        // Dead tuples are dropped in bulk once the table has doubled since the last sweep
+        if (interned.size() >= purgeAt)
+        {
+            std::erase_if(interned,[](const auto& entry)
+            {
+                return entry.second.expired();
+            });
+            purgeAt = std::max<size_t>(64,interned.size() * 2);
+        }
+
+        auto result = makeObject<Tuple>(std::move(items),true);
+        interned.emplace(hash,result);
+        return result;
+    }
+
+    TuplePrototype::TuplePrototype() : Prototype(makeScope())
+    {
+    }
+
+    void TuplePrototype::Init()
+    {
+        Prototype::Init();
+        AddNativeMemberFunction("intern",this,vectorOf<std::string>(),&TuplePrototype::Intern);
+    }
+
+    std::string TuplePrototype::ToString(const std::shared_ptr<ScopeLike>& scope) const
+    {
+        return "<Prototype : Tuple>";
+    }
+
+    std::shared_ptr<DynamicObject> TuplePrototype::CreateInstance(std::shared_ptr<FunctionScope>& scope)
+    {
+        return makeTuple(collectArgs(scope));
+    }
+
+    std::string TuplePrototype::GetName() const
+    {
+        return "Tuple";
+    }
+
+    std::shared_ptr<Object> TuplePrototype::Intern(const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        return makeInternedTuple(collectArgs(fnScope));
+    }
+}
@@ -5,6 +5,7 @@
 #include "scriptpp/utils.hpp"
 #include "scriptpp/runtime/Boolean.hpp"
 #include "scriptpp/runtime/Exception.hpp"
+#include "scriptpp/runtime/Iterator.hpp"
 #include "scriptpp/runtime/List.hpp"
 #include "scriptpp/runtime/Null.hpp"
 #include "scriptpp/runtime/Number.hpp"
@@ -63,13 +64,9 @@ namespace spp::runtime
         {
             if (auto evalResult = evalStatement(statement, scope))
             {
-                if (evalResult->GetType() == EObjectType::ReturnValue)
+                // Return, break and continue stop the scope, the function/loop that owns them handles the rest
+                if (evalResult->GetType() == EObjectType::ReturnValue || evalResult->GetType() == EObjectType::FlowControl)
                 {
-                    if (scope->GetScopeType() == ST_Function)
-                    {
-                        return cast<ReturnValue>(evalResult)->GetValue();
-                    }
-
                     return evalResult;
                 }
 
@@ -90,6 +87,11 @@ namespace spp::runtime
         {
             if (auto evalResult = evalStatement(statement, scope))
             {
+                if (evalResult->GetType() == EObjectType::ReturnValue || evalResult->GetType() == EObjectType::FlowControl)
+                {
+                    return evalResult;
+                }
+                
                 lastResult = evalResult;
             }
         }
@@ -136,7 +138,11 @@ namespace spp::runtime
             {
                 if (const auto r = std::dynamic_pointer_cast<frontend::StringLiteralNode>(ast))
                 {
-                    return makeString(r->value);
+                    std::call_once(r->internOnce,[&r]
+                    {
+                        r->interned = makeInternedString(r->value);
+                    });
+                    return r->interned;
                 }
                 throw makeException(scope,"Expected string literal",ast->debugInfo);
             }
@@ -234,7 +240,15 @@ namespace spp::runtime
     std::shared_ptr<Function> evalFunction(const std::shared_ptr<frontend::FunctionNode>& ast,
                                          const std::shared_ptr<ScopeLike>& scope)
     {
-        return makeRuntimeFunction(scope, ast);
+        auto fn = makeRuntimeFunction(findCaptureScope(scope, *ast), ast, false);
+
+        // Anonymous functions are not stored, the scope would keep the closure and the closure the scope
+        if (!ast->name.empty())
+        {
+            scope->Assign(ast->name, fn);
+        }
+
+        return fn;
     }
 
     std::pair<std::shared_ptr<Function>, std::shared_ptr<ScopeLike>> resolveCallable(
@@ -265,29 +279,69 @@ namespace spp::runtime
         return {};
     }
 
-    std::shared_ptr<Object> callFunction(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<Function>& fn,
-                                         const std::shared_ptr<ScopeLike>& scope)
+    // Indexed arguments are passed as references so the callee can assign through them
+    std::shared_ptr<Object> evalArgument(const std::shared_ptr<frontend::Node>& ast, const std::shared_ptr<ScopeLike>& scope)
     {
-        std::vector<std::shared_ptr<Object>> positionalArgs{};
-        std::unordered_map<std::string,std::shared_ptr<Object>> namedArgs{};
-        
-        for(auto &[id,arg] : ast->namedArguments)
+        if (ast->type == frontend::NodeType::Index)
+        {
+            if (const auto asIndex = std::dynamic_pointer_cast<frontend::IndexNode>(ast))
+            {
+                return evalIndex(asIndex, scope, true);
+            }
+        }
+
+        return evalExpression(ast, scope);
+    }
+
+    void evalCallArguments(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<ScopeLike>& scope,
+                           std::vector<std::shared_ptr<Object>>& positionalArgs, NamedArguments& namedArgs)
+    {
+        // Named arguments are matched to parameter slots by the callee, no map is built when there are none
+        if(!ast->namedArguments.empty())
         {
-            namedArgs.insert_or_assign(id,evalExpression(arg,scope));
+            namedArgs.reserve(ast->namedArguments.size());
+            for(auto &[id,arg] : ast->namedArguments)
+            {
+                namedArgs.emplace_back(id,evalArgument(arg,scope));
+            }
         }
 
+        positionalArgs.reserve(ast->positionalArguments.size());
         for(auto &arg : ast->positionalArguments)
         {
-            positionalArgs.push_back(evalExpression(arg,scope));
+            positionalArgs.push_back(evalArgument(arg,scope));
         }
-        
-        return fn->Call(positionalArgs,namedArgs,makeCallScope(ast->debugInfo,scope));
     }
-    
 
-    std::shared_ptr<Object> evalCall(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<ScopeLike>& scope)
+    std::shared_ptr<Object> callFunction(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<Function>& fn,
+                                         const std::shared_ptr<ScopeLike>& scope)
+    {
+        if(!fn->IsCalledThroughFrame())
+        {
+            std::vector<std::shared_ptr<Object>> positionalArgs{};
+            NamedArguments namedArgs{};
+            evalCallArguments(ast,scope,positionalArgs,namedArgs);
+
+            auto callScope = makeCallScope(ast->debugInfo,scope);
+            auto result = fn->Call(std::move(positionalArgs),std::move(namedArgs),callScope);
+            releaseCallScope(std::move(callScope));
+            return result;
+        }
+
+        // Arguments are evaluated straight into the callee's frame, a pooled frame already has room for them
+        auto callScope = makeCallScope(ast->debugInfo,scope);
+        auto fnScope = makeFunctionScope(fn,callScope,fn->GetDeclarationScope(),fn->GetLayout());
+        evalCallArguments(ast,scope,fnScope->GetArgumentStorage(),fnScope->GetNamedArgumentStorage());
+        fnScope->BindArguments();
+
+        auto result = fn->HandleCall(fnScope);
+        releaseFunctionScope(std::move(fnScope));
+        releaseCallScope(std::move(callScope));
+        return result;
+    }
+
+    std::shared_ptr<Function> evalCallTarget(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<ScopeLike>& scope)
     {
-        
         if (const auto obj = evalExpression(ast->left, scope))
         {
             const auto target = resolveReference(obj);
@@ -299,13 +353,70 @@ namespace spp::runtime
             
             if(auto [asCall,callScope] = resolveCallable(target,scope); asCall)
             {
-                return callFunction(ast, asCall, scope);
+                return asCall;
             }
         }
 
         throw makeException(scope,"Call Failed",ast->debugInfo);
     }
 
+    std::shared_ptr<Object> evalCall(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<ScopeLike>& scope)
+    {
+        return callFunction(ast, evalCallTarget(ast, scope), scope);
+    }
+
+    // Arguments referring to variables of the returning frame are passed by value, the frame is gone by the time the
+    // tail call runs and keeping it alive would chain every frame of the recursion together
+    std::shared_ptr<Object> detachArgument(const std::shared_ptr<Object>& arg, const std::shared_ptr<FunctionScope>& fnScope)
+    {
+        if(arg->GetType() != EObjectType::Reference)
+        {
+            return arg;
+        }
+
+        for(auto next = castStatic<Reference>(arg)->GetScope(); next; next = next->GetOuter())
+        {
+            if(next == fnScope)
+            {
+                return resolveReference(arg);
+            }
+
+            if(next->GetScopeType() == ST_Function)
+            {
+                break;
+            }
+        }
+
+        return arg;
+    }
+
+    void evalTailCall(const std::shared_ptr<frontend::CallNode>& ast, const std::shared_ptr<FunctionScope>& fnScope,
+                      const std::shared_ptr<ScopeLike>& scope)
+    {
+        TailCall tailCall{evalCallTarget(ast, scope)};
+        evalCallArguments(ast,scope,tailCall.positionalArgs,tailCall.namedArgs);
+
+        for(auto &arg : tailCall.positionalArgs)
+        {
+            arg = detachArgument(arg,fnScope);
+        }
+
+        for(auto &[id,arg] : tailCall.namedArgs)
+        {
+            arg = detachArgument(arg,fnScope);
+        }
+
+        // The callee is reported as called from the returning function's caller
+        auto callerScope = fnScope->GetCallerScope();
+        if(const auto asCallScope = cast<CallScope>(callerScope))
+        {
+            callerScope = asCallScope->GetActual();
+        }
+
+        tailCall.callScope = makeCallScope(ast->debugInfo,callerScope);
+        fnScope->SetTailCall(std::move(tailCall));
+    }
+
     std::shared_ptr<Object> evalFor(const std::shared_ptr<frontend::ForNode>& ast, const std::shared_ptr<ScopeLike>& scope)
     {
         std::shared_ptr<Object> result = makeNull();
@@ -346,6 +457,68 @@ namespace spp::runtime
         return result;
     }
 
+    std::shared_ptr<Object> evalForIn(const std::shared_ptr<frontend::ForInNode>& ast, const std::shared_ptr<ScopeLike>& scope)
+    {
+        std::shared_ptr<Object> result = makeNull();
+        const auto source = resolveReference(evalExpression(ast->iterable, scope));
+
+        // Runs the body once, returns false when the loop should stop. Like for loops the variable lives in the enclosing scope
+        const auto runBody = [&](const std::shared_ptr<Object>& item)
+        {
+            scope->Assign(ast->id, item);
+            if (auto temp = resolveReference(runScope(ast->body, scope)))
+            {
+                if (temp->GetType() == EObjectType::ReturnValue)
+                {
+                    if (scope->HasScopeType(ST_Function))
+                    {
+                        result = temp;
+                        return false;
+                    }
+                }
+                else if (temp->GetType() == EObjectType::FlowControl)
+                {
+                    if (const auto flow = cast<FlowControl>(temp); flow && flow->GetValue() == FlowControl::Break)
+                    {
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                result = temp;
+            }
+
+            return true;
+        };
+
+        // Lists are walked by index directly, no iterator or item references needed
+        if (const auto list = cast<List>(source))
+        {
+            for (size_t i = 0; i < list->GetSize(); i++)
+            {
+                if (!runBody(list->GetItem(i)))
+                {
+                    break;
+                }
+            }
+
+            return result;
+        }
+
+        const auto iterator = makeIterator(source, scope);
+        std::shared_ptr<Object> item;
+        while (iterator->Next(item, scope))
+        {
+            if (!runBody(item))
+            {
+                break;
+            }
+        }
+
+        return result;
+    }
+
     std::shared_ptr<Object> evalWhile(const std::shared_ptr<frontend::WhileNode>& ast,
                                     const std::shared_ptr<ScopeLike>& scope)
     {
@@ -430,7 +603,19 @@ namespace spp::runtime
                 {
                     if (scope->HasScopeType(ST_Function))
                     {
-                        return makeReturnValue(evalExpression(a->expression, scope));
+                        if (const auto fnScope = findFunctionScope(scope))
+                        {
+                            // The call is made by the function once this frame is done so tail recursion runs in a loop
+                            if (a->expression->type == frontend::NodeType::Call)
+                            {
+                                evalTailCall(std::dynamic_pointer_cast<frontend::CallNode>(a->expression), fnScope, scope);
+                                return makeReturnValue();
+                            }
+
+                            // Stored resolved so the result does not keep a reference into the returning frame
+                            fnScope->SetResult(resolveReference(evalExpression(a->expression, scope)));
+                            return makeReturnValue();
+                        }
                     }
                     return evalExpression(a->expression, scope);
                 }
@@ -468,6 +653,14 @@ namespace spp::runtime
                 }
             }
             break;
+        case frontend::NodeType::ForIn:
+            {
+                if (const auto a = std::dynamic_pointer_cast<frontend::ForInNode>(ast))
+                {
+                    return evalForIn(a, scope);
+                }
+            }
+            break;
         case frontend::NodeType::While:
             {
                 if (const auto a = std::dynamic_pointer_cast<frontend::WhileNode>(ast))
@@ -508,7 +701,7 @@ namespace spp::runtime
     }
 
     std::shared_ptr<Object> evalIndex(const std::shared_ptr<frontend::IndexNode>& ast,
-                                      const std::shared_ptr<ScopeLike>& scope)
+                                      const std::shared_ptr<ScopeLike>& scope,bool keepReference)
     {
         const auto target = evalExpression(ast->left, scope);
         if (const auto rTarget = cast<DynamicObject>(resolveReference(target)))
@@ -516,6 +709,15 @@ namespace spp::runtime
             const auto within = evalExpression(ast->within, scope);
             const auto rWithin = resolveReference(within);
 
+            // Reads the list slot directly unless the caller needs a reference it can write through
+            if(!keepReference && rWithin->GetType() == EObjectType::Number)
+            {
+                if(const auto list = cast<List>(rTarget))
+                {
+                    return list->GetAt(castStatic<Number>(rWithin)->GetValueAs<int64_t>(),scope);
+                }
+            }
+
             if(auto getResult = rTarget->Get(rWithin, scope))
             {
                 return getResult;
@@ -539,6 +741,17 @@ namespace spp::runtime
                     auto trueKey = resolveReference(evalExpression(asIndex->within,scope));
                     auto right = evalExpression(ast->value,scope);
                     auto trueVal = resolveReference(right);
+
+                    // Stores straight into the list slot without going through the generic keyed Set
+                    if(trueKey->GetType() == EObjectType::Number)
+                    {
+                        if(const auto list = cast<List>(target))
+                        {
+                            list->SetAt(castStatic<Number>(trueKey)->GetValueAs<int64_t>(),trueVal,scope);
+                            return right;
+                        }
+                    }
+                    
                     target->Set(trueKey,trueVal,scope);
                     return right;
                 }
@@ -572,7 +785,21 @@ namespace spp::runtime
     {
         try
         {
-            return runScope(ast->tryScope,scope);
+            auto result = runScope(ast->tryScope,scope);
+
+            // A tail call returned from the try block runs here so the catch still sees what it throws
+            if(result->GetType() == EObjectType::ReturnValue)
+            {
+                if(const auto fnScope = findFunctionScope(scope))
+                {
+                    if(TailCall tailCall; fnScope->TakeTailCall(tailCall))
+                    {
+                        fnScope->SetResult(runTailCalls(std::move(tailCall)));
+                    }
+                }
+            }
+
+            return result;
         }
         catch (ExceptionContainer & e)
         {
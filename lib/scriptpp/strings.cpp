@@ -0,0 +1,309 @@
+#include "scriptpp/strings.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// The AVX2 search is always compiled on x86-64 and only picked at runtime when the CPU has it, so a baseline build
+// still uses it where available
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SPP_STRINGS_AVX2
+#define SPP_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_M_X64)
+#include <immintrin.h>
+#define SPP_STRINGS_AVX2
+#define SPP_TARGET_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPP_STRINGS_SSE2
+#endif
+
+namespace spp::strings
+{
+    namespace
+    {
+        uint32_t lowestBit(uint32_t mask)
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index,mask);
+            return index;
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        size_t findScalar(std::string_view str, std::string_view needle, size_t start)
+        {
+            return str.find(needle,start);
+        }
+
+#ifdef SPP_STRINGS_SSE2
+        // Candidate positions are the ones where both the first and the last byte of the needle match,
+        // only those are compared in full. The tail that does not fill a block is left to the scalar search.
+        size_t findSse2(std::string_view str, std::string_view needle, size_t start)
+        {
+            const auto n = needle.size();
+            const auto data = str.data();
+            const auto first = _mm_set1_epi8(needle.front());
+            const auto last = _mm_set1_epi8(needle.back());
+            
+            size_t i = start;
+            for(; i + n - 1 + 16 <= str.size(); i += 16)
+            {
+                const auto blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                const auto blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst,first),_mm_cmpeq_epi8(blockLast,last))));
+                
+                while(mask != 0)
+                {
+                    const auto offset = lowestBit(mask);
+                    if(std::memcmp(data + i + offset + 1,needle.data() + 1,n > 2 ? n - 2 : 0) == 0)
+                    {
+                        return i + offset;
+                    }
+                    
+                    mask &= mask - 1;
+                }
+            }
+
+            return findScalar(str,needle,i);
+        }
+#endif
+
+#ifdef SPP_STRINGS_AVX2
+        bool hasAvx2()
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            // AVX2 needs the CPU feature and an OS that saves the ymm registers
+            int info[4];
+            __cpuid(info,1);
+            if((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+            {
+                return false;
+            }
+
+            __cpuidex(info,7,0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        SPP_TARGET_AVX2 size_t findAvx2(std::string_view str, std::string_view needle, size_t start)
+        {
+            const auto n = needle.size();
+            const auto data = str.data();
+            const auto first = _mm256_set1_epi8(needle.front());
+            const auto last = _mm256_set1_epi8(needle.back());
+            
+            size_t i = start;
+            for(; i + n - 1 + 32 <= str.size(); i += 32)
+            {
+                const auto blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                const auto blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + n - 1));
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst,first),_mm256_cmpeq_epi8(blockLast,last))));
+                
+                while(mask != 0)
+                {
+                    const auto offset = lowestBit(mask);
+                    if(std::memcmp(data + i + offset + 1,needle.data() + 1,n > 2 ? n - 2 : 0) == 0)
+                    {
+                        return i + offset;
+                    }
+                    
+                    mask &= mask - 1;
+                }
+            }
+
+            return findSse2(str,needle,i);
+        }
+#endif
+
+        // Flips the case of every byte in [from,to] by xor-ing in 0x20
+        void flipCase(std::string& str, char from, char to)
+        {
+            auto data = str.data();
+            size_t i = 0;
+#ifdef SPP_STRINGS_SSE2
+            // Shift the range so it starts at -128, then a single signed compare tests membership
+            const auto shift = _mm_set1_epi8(static_cast<char>(0x80 - from));
+            const auto limit = _mm_set1_epi8(static_cast<char>(-128 + (to - from + 1)));
+            const auto flip = _mm_set1_epi8(0x20);
+            for(; i + 16 <= str.size(); i += 16)
+            {
+                const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                const auto inRange = _mm_cmplt_epi8(_mm_add_epi8(block,shift),limit);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i),_mm_xor_si128(block,_mm_and_si128(inRange,flip)));
+            }
+#endif
+            for(; i < str.size(); i++)
+            {
+                if(data[i] >= from && data[i] <= to)
+                {
+                    data[i] ^= 0x20;
+                }
+            }
+        }
+    }
+
+    size_t find(std::string_view str, std::string_view needle, size_t start)
+    {
+        if(needle.empty())
+        {
+            return start <= str.size() ? start : npos;
+        }
+        
+        if(start >= str.size() || needle.size() > str.size() - start)
+        {
+            return npos;
+        }
+
+        // Single bytes are already handled by memchr
+        if(needle.size() == 1)
+        {
+            return str.find(needle.front(),start);
+        }
+        
+#if defined(SPP_STRINGS_AVX2)
+        static const auto useAvx2 = hasAvx2();
+        if(useAvx2)
+        {
+            return findAvx2(str,needle,start);
+        }
+#endif
+#if defined(SPP_STRINGS_SSE2)
+        return findSse2(str,needle,start);
+#else
+        return findScalar(str,needle,start);
+#endif
+    }
+
+    bool contains(std::string_view str, std::string_view needle)
+    {
+        return find(str,needle) != npos;
+    }
+
+    bool startsWith(std::string_view str, std::string_view prefix)
+    {
+        return str.starts_with(prefix);
+    }
+
+    bool endsWith(std::string_view str, std::string_view suffix)
+    {
+        return str.ends_with(suffix);
+    }
+
+    void split(std::vector<std::string_view>& result, std::string_view str, std::string_view delimiter)
+    {
+        if(delimiter.empty())
+        {
+            result.reserve(result.size() + str.size());
+            for(size_t i = 0; i < str.size(); i++)
+            {
+                result.push_back(str.substr(i,1));
+            }
+
+            return;
+        }
+
+        size_t start = 0;
+        for(auto pos = find(str,delimiter); pos != npos; pos = find(str,delimiter,start))
+        {
+            result.push_back(str.substr(start,pos - start));
+            start = pos + delimiter.size();
+        }
+
+        result.push_back(str.substr(start));
+    }
+
+    std::string_view trim(std::string_view str)
+    {
+        // A plain loop, find_first_not_of runs a search over the set for every byte
+        const auto isWhitespace = [](const char c)
+        {
+            return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+        };
+
+        size_t start = 0;
+        while(start < str.size() && isWhitespace(str[start]))
+        {
+            start++;
+        }
+
+        size_t end = str.size();
+        while(end > start && isWhitespace(str[end - 1]))
+        {
+            end--;
+        }
+
+        return str.substr(start,end - start);
+    }
+
+    std::string replace(std::string_view str, std::string_view from, std::string_view to)
+    {
+        if(from.empty())
+        {
+            return std::string(str);
+        }
+        
+        std::string result;
+        size_t start = 0;
+        for(auto pos = find(str,from); pos != npos; pos = find(str,from,start))
+        {
+            if(result.empty())
+            {
+                // Only pay for the reservation once we know there is something to replace
+                result.reserve(str.size());
+            }
+            
+            result.append(str.substr(start,pos - start));
+            result.append(to);
+            start = pos + from.size();
+        }
+
+        result.append(str.substr(start));
+        return result;
+    }
+
+    std::string repeat(std::string_view str, size_t times)
+    {
+        std::string result;
+        if(str.empty() || times == 0)
+        {
+            return result;
+        }
+        
+        result.reserve(str.size() * times);
+        result.append(str);
+
+        // Double the filled prefix until the target size is reached
+        while(result.size() * 2 <= str.size() * times)
+        {
+            result.append(result);
+        }
+
+        result.append(result.data(),str.size() * times - result.size());
+        return result;
+    }
+
+    std::string toUpper(std::string_view str)
+    {
+        std::string result(str);
+        flipCase(result,'a','z');
+        return result;
+    }
+
+    std::string toLower(std::string_view str)
+    {
+        std::string result(str);
+        flipCase(result,'A','Z');
+        return result;
+    }
+}
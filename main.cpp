@@ -7,23 +7,21 @@
 
 using namespace spp;
 
+void print(runtime::NativeArgs args, runtime::NativeCallContext& ctx)
+{
+    for (const auto& arg : args)
+    {
+        std::cout << arg->ToString(ctx.GetCallScope()) << " ";
+    }
+    std::cout << '\n';
+}
 
 
 void runRepl()
 {
         auto program = runtime::makeProgram();
 
-        program->AddLambda("print", {}, [](const std::shared_ptr<runtime::FunctionScope>& scope)
-        {
-            for (const auto& arg : scope->GetPositionalArgs())
-            {
-                auto s = arg->ToString(scope);
-                std::cout << arg->ToString(scope) << " ";
-            }
-            std::cout << '\n';
-        
-            return runtime::makeNull();
-        });
+        program->AddNative("print", {}, runtime::bindNative<&print>());
         
         program->AddLambda("input", {"prompt"}, [](const std::shared_ptr<runtime::FunctionScope>& scope)
         {
@@ -117,17 +115,7 @@ int main(const int argc, char *argv[])
     {
         const auto program = runtime::makeProgram();
 
-        program->AddLambda("print", {}, [](const std::shared_ptr<runtime::FunctionScope>& scope)
-        {
-            for (const auto& arg : scope->GetPositionalArgs())
-            {
-                auto s = arg->ToString(scope);
-                std::cout << arg->ToString(scope) << " ";
-            }
-            std::cout << '\n';
-        
-            return runtime::makeNull();
-        });
+        program->AddNative("print", {}, runtime::bindNative<&print>());
         
         program->AddLambda("input", {"prompt"}, [](const std::shared_ptr<runtime::FunctionScope>& scope)
         {